@@ -0,0 +1,181 @@
+//
+// Concept dispatched algorithms benchmark: Copy, Fill, Find, Count, Equal,
+// LexicographicalCompare on vector, deque and list; generic loops vs
+// dispatched overloads vs std::
+// Usage: algorithms [num elements, default 2^22] [repetitions, default 16]
+// Author: Ugo Varetto
+//
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "algorithms.h"
+
+using namespace std;
+
+using Clock = chrono::high_resolution_clock;
+template <typename TimeDiffNsT>
+constexpr double NsToSec(const TimeDiffNsT& diff) {
+    return double(chrono::duration_cast<chrono::nanoseconds>(diff).count()) /
+           1E9;
+}
+
+//------------------------------------------------------------------------------
+static_assert(ContiguousIntegral<vector<int>::iterator>);
+static_assert(ContiguousTrivial<const float*>);
+static_assert(!ContiguousBitwise<const float*>);
+static_assert(!ContiguousTrivial<deque<int>::iterator>);
+
+struct Padded {
+    char c;
+    int i;
+};
+static_assert(ContiguousTrivial<Padded*> && !ContiguousBitwise<Padded*>);
+
+// returns result of last call, prints G elements/s
+template <typename F>
+size_t Time(size_t n, int reps, F f) {
+    size_t r = 0;
+    const auto start = Clock::now();
+    for (int i = 0; i != reps; ++i) {
+        r = f();
+        // memchr and memcmp are pure: don't let repeated calls be merged
+        asm volatile("" ::: "memory");
+    }
+    const double t = NsToSec(Clock::now() - start);
+    cout << setw(10) << setprecision(3) << double(n) * reps / t / 1E9;
+    return r;
+}
+
+// generic, dispatched, std:: on the same input, true if results agree
+template <typename G, typename D, typename S>
+bool Row(const string& label, size_t n, int reps, G g, D d, S s) {
+    cout << "  " << label << string(max(1, 12 - int(label.size())), ' ');
+    const size_t rg = Time(n, reps, g);
+    const size_t rd = Time(n, reps, d);
+    const size_t rs = Time(n, reps, s);
+    cout << endl;
+    return rg == rd && rd == rs;
+}
+
+template <typename C>
+bool Bench(const string& name, size_t n, int reps) {
+    using T = typename C::value_type;
+    namespace gen = algorithms_detail;
+    mt19937 rng(5);
+    vector<T> init(n);
+    for (auto& x : init) x = T(rng() % 100);
+    // searched value only at the end: find scans everything
+    if (n) init[n - 1] = T(101);
+    C a(init.begin(), init.end()), b(a), out(n);
+    // mismatch on the last element
+    C c(a);
+    *prev(c.end()) = T(102);
+    auto last = [](const C& x) { return size_t(*prev(x.end())); };
+    cout << name << ", G elements/s: generic, dispatched, std::" << endl;
+    bool ok = Row(
+        "copy", n, reps,
+        [&] {
+            gen::CopyGeneric(a.begin(), a.end(), out.begin());
+            return last(out);
+        },
+        [&] { return Copy(a.begin(), a.end(), out.begin()), last(out); },
+        [&] { return copy(a.begin(), a.end(), out.begin()), last(out); });
+    for (T v : {T(0), T(7)}) {
+        auto f = [&](auto fill) {
+            return [&, fill] { return fill(), last(out); };
+        };
+        ok = Row("fill " + to_string(int(v)), n, reps,
+                 f([&] { gen::FillGeneric(out.begin(), out.end(), v); }),
+                 f([&] { Fill(out.begin(), out.end(), v); }),
+                 f([&] { fill(out.begin(), out.end(), v); })) &&
+             ok;
+    }
+    auto pos = [&](auto i) { return size_t(distance(a.begin(), i)); };
+    const T x = T(101);
+    ok = Row(
+             "find", n, reps,
+             [&] { return pos(gen::FindGeneric(a.begin(), a.end(), x)); },
+             [&] { return pos(Find(a.begin(), a.end(), x)); },
+             [&] { return pos(find(a.begin(), a.end(), x)); }) &&
+         ok;
+    ok = Row(
+             "count", n, reps,
+             [&] { return gen::CountGeneric(a.begin(), a.end(), T(42)); },
+             [&] { return Count(a.begin(), a.end(), T(42)); },
+             [&] { return size_t(count(a.begin(), a.end(), T(42))); }) &&
+         ok;
+    ok = Row(
+             "equal", n, reps,
+             [&] {
+                 return size_t(
+                     gen::MismatchGeneric(a.begin(), a.end(), b.begin())
+                         .first == a.end());
+             },
+             [&] { return size_t(Equal(a.begin(), a.end(), b.begin())); },
+             [&] { return size_t(equal(a.begin(), a.end(), b.begin())); }) &&
+         ok;
+    ok = Row(
+             "lex compare", n, reps,
+             [&] {
+                 return size_t(gen::LexicographicalCompareGeneric(
+                     a.begin(), a.end(), c.begin(), c.end()));
+             },
+             [&] {
+                 return size_t(LexicographicalCompare(a.begin(), a.end(),
+                                                      c.begin(), c.end()));
+             },
+             [&] {
+                 return size_t(lexicographical_compare(a.begin(), a.end(),
+                                                       c.begin(), c.end()));
+             }) &&
+         ok;
+    return ok;
+}
+
+// Find and Count against std:: with values of a different type, mixed
+// signedness and out of range
+template <typename C, typename T>
+bool SameAsStd(const C& c, T v) {
+    return Find(c.begin(), c.end(), v) == find(c.begin(), c.end(), v) &&
+           Count(c.begin(), c.end(), v) == size_t(count(c.begin(), c.end(), v));
+}
+
+bool ValueConversions() {
+    const vector<uint32_t> u = {1, 2, 0xFFFFFFFF, 4};
+    const vector<int64_t> s = {1, -1};
+    const vector<uint8_t> b = {1, 255};
+    const vector<int16_t> h = {1, -1, 300};
+    return SameAsStd(u, -1) && SameAsStd(u, int64_t(-1)) &&
+           SameAsStd(u, uint64_t(0xFFFFFFFF)) && SameAsStd(s, UINT64_MAX) &&
+           SameAsStd(s, -1) && SameAsStd(b, -1) && SameAsStd(b, 255) &&
+           SameAsStd(b, 511) && SameAsStd(h, 0xFFFFFFFFu) &&
+           SameAsStd(h, uint16_t(0xFFFF)) && SameAsStd(h, 300u) &&
+           SameAsStd(h, 65836);
+}
+
+//------------------------------------------------------------------------------
+int main(int argc, char const* argv[]) {
+    const size_t n = argc > 1 ? stoull(argv[1]) : size_t(1) << 22;
+    const int reps = argc > 2 ? stoi(argv[2]) : 16;
+    if (!ValueConversions()) {
+        cerr << "ERROR: Find/Count differ from std::find/count" << endl;
+        return 1;
+    }
+    cout << n << " elements" << endl;
+    bool ok = Bench<vector<int32_t>>("vector<int32_t>", n, reps);
+    ok = Bench<vector<uint8_t>>("vector<uint8_t>", n, reps) && ok;
+    ok = Bench<vector<int8_t>>("vector<int8_t>", n, reps) && ok;
+    ok = Bench<deque<int32_t>>("deque<int32_t>", n, reps) && ok;
+    ok = Bench<list<int32_t>>("list<int32_t>", n, max(1, reps / 8)) && ok;
+    cout << (ok ? "results match" : "ERROR: results differ") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,410 @@
+// Author: Ugo Varetto
+// Algorithms overloaded on iterator concepts, as Advance in concepts.cpp:
+// the generic version works on any iterator, the more constrained overload
+// for contiguous iterators over trivially copyable types goes to memmove,
+// memset, memchr, memcmp or AVX2 kernels (selected at run time).
+// - Copy:  memmove
+// - Fill:  memset when every byte of the value is the same
+// - Find:  memchr for bytes, AVX2 compare + movemask for 2, 4, 8 bytes
+// - Count: AVX2 compare and subtract for 1 and 4 byte integers
+// - Equal, Mismatch: bytewise compare, valid for types with unique object
+//   representations (no padding, no floating point)
+// - LexicographicalCompare: memcmp for unsigned bytes, bytewise Mismatch
+//   then operator< for other integers
+
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ALGORITHMS_X86
+#include <immintrin.h>
+#endif
+
+// Contiguous storage of trivially copyable values: raw memory operations
+template <typename I>
+concept ContiguousTrivial =
+    std::contiguous_iterator<I> &&
+    std::is_trivially_copyable<std::iter_value_t<I>>::value;
+
+// Equality of values is equality of bytes
+template <typename I>
+concept ContiguousBitwise =
+    ContiguousTrivial<I> &&
+    std::has_unique_object_representations<std::iter_value_t<I>>::value;
+
+// Contiguous integers: SIMD compare kernels
+template <typename I>
+concept ContiguousIntegral =
+    ContiguousBitwise<I> && std::is_integral<std::iter_value_t<I>>::value &&
+    !std::same_as<std::iter_value_t<I>, bool>;
+
+//------------------------------------------------------------------------------
+namespace algorithms_detail {
+inline bool HasAVX2() {
+#ifdef ALGORITHMS_X86
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+#else
+    return false;
+#endif
+}
+
+template <typename T>
+const unsigned char* Bytes(const T* p) {
+    return reinterpret_cast<const unsigned char*>(p);
+}
+
+// true if V(v) compares equal to v under the built-in ==, the comparison
+// the generic loops use: then *it == v is *it == V(v) and the typed kernels
+// apply (with mixed signedness -1 matches the all ones unsigned value, as
+// in std::find)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsign-compare"
+template <typename V, typename T>
+constexpr bool Representable(T v) {
+    return static_cast<V>(v) == v;
+}
+#pragma GCC diagnostic pop
+
+// with equal signedness V(v) != v means no element can compare equal to v,
+// with mixed signedness the generic loop decides
+template <typename V, typename T>
+constexpr bool MixedSign() {
+    return std::is_signed<V>::value != std::is_signed<T>::value;
+}
+
+// Index of first differing byte, n if equal
+inline std::size_t MismatchScalar(const unsigned char* a,
+                                  const unsigned char* b, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t x, y;
+        std::memcpy(&x, a + i, 8);
+        std::memcpy(&y, b + i, 8);
+        if (x != y) break;
+    }
+    while (i != n && a[i] == b[i]) ++i;
+    return i;
+}
+
+#ifdef ALGORITHMS_X86
+__attribute__((target("avx2"))) inline std::size_t MismatchAVX2(
+    const unsigned char* a, const unsigned char* b, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+        const __m256i y = _mm256_loadu_si256((const __m256i*)(b + i));
+        const uint32_t eq =
+            uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)));
+        if (eq != ~uint32_t(0)) return i + __builtin_ctz(~eq);
+    }
+    return i + MismatchScalar(a + i, b + i, n - i);
+}
+
+template <typename T>
+__attribute__((target("avx2"))) inline __m256i CmpEq(__m256i a, __m256i b) {
+    if constexpr (sizeof(T) == 1) return _mm256_cmpeq_epi8(a, b);
+    if constexpr (sizeof(T) == 2) return _mm256_cmpeq_epi16(a, b);
+    if constexpr (sizeof(T) == 4) return _mm256_cmpeq_epi32(a, b);
+    if constexpr (sizeof(T) == 8) return _mm256_cmpeq_epi64(a, b);
+}
+
+template <typename T>
+__attribute__((target("avx2"))) inline __m256i Broadcast(T v) {
+    if constexpr (sizeof(T) == 1) return _mm256_set1_epi8(char(v));
+    if constexpr (sizeof(T) == 2) return _mm256_set1_epi16(short(v));
+    if constexpr (sizeof(T) == 4) return _mm256_set1_epi32(int(v));
+    if constexpr (sizeof(T) == 8) return _mm256_set1_epi64x((long long)(v));
+}
+
+// Index of first element equal to v, n if not found; movemask gives one
+// bit per byte, sizeof(T) bits per matching element
+template <typename T>
+__attribute__((target("avx2"))) std::size_t FindAVX2(const T* p,
+                                                     std::size_t n, T v) {
+    constexpr std::size_t W = 32 / sizeof(T);
+    const __m256i vv = Broadcast(v);
+    std::size_t i = 0;
+    for (; i + 2 * W <= n; i += 2 * W) {
+        const __m256i a = _mm256_loadu_si256((const __m256i*)(p + i));
+        const __m256i b = _mm256_loadu_si256((const __m256i*)(p + i + W));
+        const __m256i ea = CmpEq<T>(a, vv), eb = CmpEq<T>(b, vv);
+        if (!_mm256_testz_si256(_mm256_or_si256(ea, eb),
+                                _mm256_or_si256(ea, eb))) {
+            const uint64_t m =
+                uint64_t(uint32_t(_mm256_movemask_epi8(ea))) |
+                uint64_t(uint32_t(_mm256_movemask_epi8(eb))) << 32;
+            return i + __builtin_ctzll(m) / sizeof(T);
+        }
+    }
+    while (i != n && p[i] != v) ++i;
+    return i;
+}
+
+// Matches are -1: subtracting the compare result counts them. Byte lanes
+// overflow after 255 iterations, widened with psadbw before that
+template <typename T>
+__attribute__((target("avx2"))) std::size_t CountAVX2(const T* p,
+                                                      std::size_t n, T v) {
+    static_assert(sizeof(T) == 1 || sizeof(T) == 4);
+    constexpr std::size_t W = 32 / sizeof(T);
+    const __m256i vv = Broadcast(v);
+    __m256i total = _mm256_setzero_si256();
+    std::size_t i = 0;
+    while (i + W <= n) {
+        __m256i acc = _mm256_setzero_si256();
+        const std::size_t steps = std::min<std::size_t>(255, (n - i) / W);
+        for (std::size_t s = 0; s != steps; ++s, i += W) {
+            const __m256i x = _mm256_loadu_si256((const __m256i*)(p + i));
+            if constexpr (sizeof(T) == 1)
+                acc = _mm256_sub_epi8(acc, CmpEq<T>(x, vv));
+            else
+                acc = _mm256_sub_epi32(acc, CmpEq<T>(x, vv));
+        }
+        if constexpr (sizeof(T) == 1) {
+            total = _mm256_add_epi64(
+                total, _mm256_sad_epu8(acc, _mm256_setzero_si256()));
+        } else {
+            // 32 bit counts to 64 bit lanes
+            total = _mm256_add_epi64(
+                total,
+                _mm256_add_epi64(_mm256_and_si256(
+                                     acc, _mm256_set1_epi64x(0xFFFFFFFF)),
+                                 _mm256_srli_epi64(acc, 32)));
+        }
+    }
+    std::size_t c = std::size_t(_mm256_extract_epi64(total, 0)) +
+                    std::size_t(_mm256_extract_epi64(total, 1)) +
+                    std::size_t(_mm256_extract_epi64(total, 2)) +
+                    std::size_t(_mm256_extract_epi64(total, 3));
+    for (; i != n; ++i) c += p[i] == v;
+    return c;
+}
+#endif
+
+inline std::size_t Mismatch(const unsigned char* a, const unsigned char* b,
+                            std::size_t n) {
+#ifdef ALGORITHMS_X86
+    if (HasAVX2()) return MismatchAVX2(a, b, n);
+#endif
+    return MismatchScalar(a, b, n);
+}
+
+// Generic versions, also used as reference in the benchmarks
+template <std::input_iterator I, std::weakly_incrementable O>
+O CopyGeneric(I first, I last, O out) {
+    for (; first != last; ++first, ++out) *out = *first;
+    return out;
+}
+
+template <std::forward_iterator I, typename T>
+void FillGeneric(I first, I last, const T& v) {
+    for (; first != last; ++first) *first = v;
+}
+
+// Find and Count mirror the built-in ==, mixed signedness included
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsign-compare"
+template <std::input_iterator I, typename T>
+I FindGeneric(I first, I last, const T& v) {
+    for (; first != last; ++first) {
+        if (*first == v) break;
+    }
+    return first;
+}
+
+template <std::input_iterator I, typename T>
+std::size_t CountGeneric(I first, I last, const T& v) {
+    std::size_t c = 0;
+    for (; first != last; ++first) c += *first == v;
+    return c;
+}
+#pragma GCC diagnostic pop
+
+template <std::input_iterator I1, std::input_iterator I2>
+std::pair<I1, I2> MismatchGeneric(I1 first1, I1 last1, I2 first2) {
+    while (first1 != last1 && *first1 == *first2) {
+        ++first1;
+        ++first2;
+    }
+    return {first1, first2};
+}
+
+template <std::input_iterator I1, std::input_iterator I2>
+bool LexicographicalCompareGeneric(I1 first1, I1 last1, I2 first2,
+                                   I2 last2) {
+    for (; first1 != last1 && first2 != last2; ++first1, ++first2) {
+        if (*first1 < *first2) return true;
+        if (*first2 < *first1) return false;
+    }
+    return first1 == last1 && first2 != last2;
+}
+}  // namespace algorithms_detail
+
+//------------------------------------------------------------------------------
+// Copy
+template <std::input_iterator I, std::weakly_incrementable O>
+    requires std::indirectly_writable<O, std::iter_reference_t<I>>
+O Copy(I first, I last, O out) {
+    return algorithms_detail::CopyGeneric(first, last, out);
+}
+
+template <ContiguousTrivial I, std::contiguous_iterator O>
+    requires std::indirectly_writable<O, std::iter_reference_t<I>> &&
+             std::same_as<std::iter_value_t<I>, std::iter_value_t<O>>
+O Copy(I first, I last, O out) {
+    const std::size_t n = last - first;
+    if (n) {
+        std::memmove(std::to_address(out), std::to_address(first),
+                     n * sizeof(std::iter_value_t<I>));
+    }
+    return out + n;
+}
+
+//------------------------------------------------------------------------------
+// Fill
+template <std::forward_iterator I, typename T>
+    requires std::indirectly_writable<I, const T&>
+void Fill(I first, I last, const T& v) {
+    algorithms_detail::FillGeneric(first, last, v);
+}
+
+template <ContiguousTrivial I, typename T>
+    requires std::indirectly_writable<I, const T&>
+void Fill(I first, I last, const T& v) {
+    using V = std::iter_value_t<I>;
+    const V x = V(v);
+    const unsigned char* b = algorithms_detail::Bytes(&x);
+    const bool bytes = std::all_of(b, b + sizeof(V),
+                                   [b](unsigned char c) { return c == *b; });
+    if (bytes)
+        std::memset(std::to_address(first), *b, (last - first) * sizeof(V));
+    else
+        algorithms_detail::FillGeneric(first, last, x);
+}
+
+//------------------------------------------------------------------------------
+// Find
+template <std::input_iterator I, typename T>
+I Find(I first, I last, const T& v) {
+    return algorithms_detail::FindGeneric(first, last, v);
+}
+
+template <ContiguousIntegral I, std::integral T>
+I Find(I first, I last, const T& v) {
+    using V = std::iter_value_t<I>;
+    if (!algorithms_detail::Representable<V>(v)) {
+        if constexpr (algorithms_detail::MixedSign<V, T>()) {
+            return algorithms_detail::FindGeneric(first, last, v);
+        }
+        // value not representable: no element can compare equal
+        return last;
+    }
+    const V* p = std::to_address(first);
+    const std::size_t n = last - first;
+    if constexpr (sizeof(V) == 1) {
+        const void* f = std::memchr(p, int(v) & 0xFF, n);
+        return f ? first + (static_cast<const V*>(f) - p) : last;
+    } else {
+#ifdef ALGORITHMS_X86
+        if (algorithms_detail::HasAVX2())
+            return first + algorithms_detail::FindAVX2(p, n, V(v));
+#endif
+        return algorithms_detail::FindGeneric(first, last, v);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Count
+template <std::input_iterator I, typename T>
+std::size_t Count(I first, I last, const T& v) {
+    return algorithms_detail::CountGeneric(first, last, v);
+}
+
+template <ContiguousIntegral I, std::integral T>
+std::size_t Count(I first, I last, const T& v) {
+    using V = std::iter_value_t<I>;
+    if (!algorithms_detail::Representable<V>(v)) {
+        if constexpr (algorithms_detail::MixedSign<V, T>()) {
+            return algorithms_detail::CountGeneric(first, last, v);
+        }
+        return 0;
+    }
+#ifdef ALGORITHMS_X86
+    if constexpr (sizeof(V) == 1 || sizeof(V) == 4) {
+        if (algorithms_detail::HasAVX2())
+            return algorithms_detail::CountAVX2(std::to_address(first),
+                                                std::size_t(last - first),
+                                                V(v));
+    }
+#endif
+    return algorithms_detail::CountGeneric(first, last, v);
+}
+
+//------------------------------------------------------------------------------
+// Mismatch and Equal
+template <std::input_iterator I1, std::input_iterator I2>
+std::pair<I1, I2> Mismatch(I1 first1, I1 last1, I2 first2) {
+    return algorithms_detail::MismatchGeneric(first1, last1, first2);
+}
+
+template <ContiguousBitwise I1, ContiguousBitwise I2>
+    requires std::same_as<std::iter_value_t<I1>, std::iter_value_t<I2>>
+std::pair<I1, I2> Mismatch(I1 first1, I1 last1, I2 first2) {
+    using V = std::iter_value_t<I1>;
+    using algorithms_detail::Bytes;
+    const std::size_t n = last1 - first1;
+    const std::size_t byte = algorithms_detail::Mismatch(
+        Bytes(std::to_address(first1)), Bytes(std::to_address(first2)),
+        n * sizeof(V));
+    return {first1 + byte / sizeof(V), first2 + byte / sizeof(V)};
+}
+
+template <std::input_iterator I1, std::input_iterator I2>
+bool Equal(I1 first1, I1 last1, I2 first2) {
+    return algorithms_detail::MismatchGeneric(first1, last1, first2).first ==
+           last1;
+}
+
+template <ContiguousBitwise I1, ContiguousBitwise I2>
+    requires std::same_as<std::iter_value_t<I1>, std::iter_value_t<I2>>
+bool Equal(I1 first1, I1 last1, I2 first2) {
+    const std::size_t n = last1 - first1;
+    return !n || !std::memcmp(std::to_address(first1), std::to_address(first2),
+                              n * sizeof(std::iter_value_t<I1>));
+}
+
+//------------------------------------------------------------------------------
+// LexicographicalCompare: true if [first1, last1) < [first2, last2)
+template <std::input_iterator I1, std::input_iterator I2>
+bool LexicographicalCompare(I1 first1, I1 last1, I2 first2, I2 last2) {
+    return algorithms_detail::LexicographicalCompareGeneric(first1, last1,
+                                                            first2, last2);
+}
+
+template <ContiguousIntegral I1, ContiguousIntegral I2>
+    requires std::same_as<std::iter_value_t<I1>, std::iter_value_t<I2>>
+bool LexicographicalCompare(I1 first1, I1 last1, I2 first2, I2 last2) {
+    using V = std::iter_value_t<I1>;
+    const std::size_t n1 = last1 - first1, n2 = last2 - first2;
+    const std::size_t n = std::min(n1, n2);
+    if constexpr (sizeof(V) == 1 && std::is_unsigned<V>::value) {
+        // byte order is value order
+        const int c = n ? std::memcmp(std::to_address(first1),
+                                      std::to_address(first2), n)
+                        : 0;
+        return c ? c < 0 : n1 < n2;
+    } else {
+        const auto [m1, m2] = Mismatch(first1, first1 + n, first2);
+        return m1 != first1 + n ? *m1 < *m2 : n1 < n2;
+    }
+}
@@ -0,0 +1,231 @@
+// Author: Ugo Varetto
+// Table driven binary/hex dump of whole buffers:
+// - each byte is expanded through a 256 entry table of precomputed digits
+// - words are rendered msb first, fields inside words are split by
+//   separators at compile time bit offsets (counted from the msb)
+// - text goes into a local buffer written to the stream in large chunks
+// DumpBits<uint32_t, 1, 9>(cout, floats, size) prints each 32 bit word as
+// sign, exponent and mantissa: 0 10000010 01000111011111001110111
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <type_traits>
+#include <vector>
+
+enum class DumpFormat { BINARY, HEX };
+
+namespace bit_dump_detail {
+//------------------------------------------------------------------------------
+// Digits of every byte value, msb first
+template <DumpFormat F>
+struct ByteTable {
+    enum : int {
+        DIGITS = F == DumpFormat::BINARY ? 8 : 2,
+        BITS_PER_DIGIT = 8 / DIGITS
+    };
+    char digits[256][DIGITS] = {};
+    constexpr ByteTable() {
+        const char HEX[] = "0123456789abcdef";
+        for (int b = 0; b != 256; ++b) {
+            for (int d = 0; d != DIGITS; ++d) {
+                const int shift = (DIGITS - 1 - d) * BITS_PER_DIGIT;
+                const int v = (b >> shift) & ((1 << BITS_PER_DIGIT) - 1);
+                digits[b][d] = HEX[v];
+            }
+        }
+    }
+};
+
+template <DumpFormat F>
+constexpr ByteTable<F> BYTE_TABLE{};
+
+//------------------------------------------------------------------------------
+template <typename WordT, DumpFormat F, int... Separators>
+class Dumper {
+    using Table = ByteTable<F>;
+    static_assert(std::is_integral<WordT>::value);
+    static_assert(((Separators > 0 && Separators < int(8 * sizeof(WordT))) &&
+                   ...),
+                  "separators must be inside the word");
+    static_assert(((Separators % Table::BITS_PER_DIGIT == 0) && ...),
+                  "separators must fall on digit boundaries");
+    enum : int {
+        WORD_DIGITS = Table::DIGITS * int(sizeof(WordT)),
+        NUM_SEPARATORS = int(sizeof...(Separators)),
+        // worst case characters for one word
+        MAX_WORD_CHARS = WORD_DIGITS + NUM_SEPARATORS + 2,
+        BUFFER_SIZE = 1 << 16
+    };
+
+   public:
+    Dumper(std::ostream& os, char wordSeparator, std::size_t wordsPerLine)
+        : os_(os),
+          buffer_(BUFFER_SIZE),
+          pos_(0),
+          wordSeparator_(wordSeparator),
+          wordsPerLine_(wordsPerLine),
+          count_(0) {}
+    ~Dumper() { Flush(); }
+    void Word(WordT w) {
+        if (pos_ + MAX_WORD_CHARS > BUFFER_SIZE) Flush();
+        char* out = buffer_.data() + pos_;
+        if constexpr (NUM_SEPARATORS == 0) {
+            Render(w, out);
+            out += WORD_DIGITS;
+        } else {
+            char digits[WORD_DIGITS];
+            Render(w, digits);
+            // digit offsets of field boundaries, sorted at compile time
+            constexpr auto FIELDS = Fields();
+            int prev = 0;
+            for (int f = 0; f != NUM_SEPARATORS; ++f) {
+                std::memcpy(out, digits + prev, FIELDS.offsets[f] - prev);
+                out += FIELDS.offsets[f] - prev;
+                *out++ = ' ';
+                prev = FIELDS.offsets[f];
+            }
+            std::memcpy(out, digits + prev, WORD_DIGITS - prev);
+            out += WORD_DIGITS - prev;
+        }
+        ++count_;
+        if (wordsPerLine_ && count_ % wordsPerLine_ == 0) {
+            *out++ = '\n';
+        } else if (wordSeparator_) {
+            *out++ = wordSeparator_;
+        }
+        pos_ = out - buffer_.data();
+    }
+    void Flush() {
+        os_.write(buffer_.data(), pos_);
+        pos_ = 0;
+    }
+
+   private:
+    static void Render(WordT w, char* out) {
+        using U = std::make_unsigned_t<WordT>;
+        const U u = U(w);
+        for (int b = int(sizeof(WordT)) - 1; b >= 0; --b) {
+            std::memcpy(out, BYTE_TABLE<F>.digits[(u >> (8 * b)) & 0xFF],
+                        Table::DIGITS);
+            out += Table::DIGITS;
+        }
+    }
+    struct FieldOffsets {
+        int offsets[NUM_SEPARATORS > 0 ? NUM_SEPARATORS : 1] = {};
+    };
+    static constexpr FieldOffsets Fields() {
+        FieldOffsets f;
+        const int seps[] = {0, Separators...};
+        for (int i = 0; i != NUM_SEPARATORS; ++i)
+            f.offsets[i] = seps[i + 1] / Table::BITS_PER_DIGIT;
+        // insertion sort: separators can be listed in any order
+        for (int i = 1; i < NUM_SEPARATORS; ++i) {
+            for (int j = i; j > 0 && f.offsets[j - 1] > f.offsets[j]; --j) {
+                const int t = f.offsets[j];
+                f.offsets[j] = f.offsets[j - 1];
+                f.offsets[j - 1] = t;
+            }
+        }
+        return f;
+    }
+
+   private:
+    std::ostream& os_;
+    std::vector<char> buffer_;
+    std::size_t pos_;
+    char wordSeparator_;
+    std::size_t wordsPerLine_;
+    std::size_t count_;
+};
+
+template <typename WordT, DumpFormat F, int... Separators>
+void Dump(std::ostream& os, const void* data, std::size_t size,
+          char wordSeparator, std::size_t wordsPerLine) {
+    const char* p = static_cast<const char*>(data);
+    const std::size_t words = size / sizeof(WordT);
+    {
+        Dumper<WordT, F, Separators...> d(os, wordSeparator, wordsPerLine);
+        for (std::size_t i = 0; i != words; ++i, p += sizeof(WordT)) {
+            WordT w;
+            std::memcpy(&w, p, sizeof(WordT));
+            d.Word(w);
+        }
+    }
+    // trailing bytes not filling a whole word
+    if (size % sizeof(WordT)) {
+        Dumper<uint8_t, F> d(os, wordSeparator, 0);
+        for (std::size_t i = words * sizeof(WordT); i != size; ++i, ++p)
+            d.Word(uint8_t(*p));
+    }
+}
+
+template <typename T>
+using HasDataSize = decltype(std::declval<const T&>().Data(),
+                             std::declval<const T&>().Size(), void());
+}  // namespace bit_dump_detail
+
+//------------------------------------------------------------------------------
+// Dump size bytes at data as words of type WordT, each word msb first,
+// words separated by wordSeparator ('\0' for none) and a new line every
+// wordsPerLine words (0 = never)
+template <typename WordT = uint8_t, int... Separators>
+void DumpBits(std::ostream& os, const void* data, std::size_t size,
+              char wordSeparator = ' ', std::size_t wordsPerLine = 0) {
+    bit_dump_detail::Dump<WordT, DumpFormat::BINARY, Separators...>(
+        os, data, size, wordSeparator, wordsPerLine);
+}
+
+template <typename WordT = uint8_t, int... Separators>
+void DumpHex(std::ostream& os, const void* data, std::size_t size,
+             char wordSeparator = ' ', std::size_t wordsPerLine = 0) {
+    bit_dump_detail::Dump<WordT, DumpFormat::HEX, Separators...>(
+        os, data, size, wordSeparator, wordsPerLine);
+}
+
+// Any buffer exposing Data() and Size(), e.g. RawBuffer
+template <typename WordT = uint8_t, int... Separators, typename BufferT,
+          typename = bit_dump_detail::HasDataSize<BufferT>>
+void DumpBits(std::ostream& os, const BufferT& buffer,
+              char wordSeparator = ' ', std::size_t wordsPerLine = 0) {
+    DumpBits<WordT, Separators...>(os, buffer.Data(), buffer.Size(),
+                                   wordSeparator, wordsPerLine);
+}
+
+template <typename WordT = uint8_t, int... Separators, typename BufferT,
+          typename = bit_dump_detail::HasDataSize<BufferT>>
+void DumpHex(std::ostream& os, const BufferT& buffer, char wordSeparator = ' ',
+             std::size_t wordsPerLine = 0) {
+    DumpHex<WordT, Separators...>(os, buffer.Data(), buffer.Size(),
+                                  wordSeparator, wordsPerLine);
+}
+
+//------------------------------------------------------------------------------
+// Single value versions
+// bits in [start, end] of n, msb first
+template <typename T>
+void PrintBits(const T n, int start = 0, const int end = 8 * sizeof(T) - 1) {
+    static_assert(std::is_integral<T>::value);
+    constexpr int BITS = 8 * sizeof(T);
+    char digits[BITS];
+    using U = std::make_unsigned_t<T>;
+    for (int b = int(sizeof(T)) - 1; b >= 0; --b) {
+        std::memcpy(digits + 8 * (sizeof(T) - 1 - b),
+                    bit_dump_detail::BYTE_TABLE<DumpFormat::BINARY>
+                        .digits[(U(n) >> (8 * b)) & 0xFF],
+                    8);
+    }
+    std::cout.write(digits + BITS - 1 - end, end - start + 1);
+}
+
+// all bits of n with a space after the first Separators bits:
+// PrintBitsSep<uint32_t, 1, 9>(IntFloat(f)) prints sign, exponent, mantissa
+template <typename T, int... Separators>
+void PrintBitsSep(const T n) {
+    static_assert(std::is_integral<T>::value);
+    bit_dump_detail::Dumper<T, DumpFormat::BINARY, Separators...>(std::cout,
+                                                                  '\0', 0)
+        .Word(n);
+}
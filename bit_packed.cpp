@@ -0,0 +1,107 @@
+//
+// Bit packed vector benchmark: memory and scan throughput of ID columns
+// stored at their bit width vs vector<uint32_t>
+// Usage: bit_packed [num values, default 2^26] [max id, default 2^20]
+// Author: Ugo Varetto
+//
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bit_packed.h"
+
+using namespace std;
+
+using Clock = chrono::high_resolution_clock;
+template <typename TimeDiffNsT>
+constexpr double NsToSec(const TimeDiffNsT& diff) {
+    return double(chrono::duration_cast<chrono::nanoseconds>(diff).count()) /
+           1E9;
+}
+
+template <typename F>
+double Time(F f) {
+    const auto start = Clock::now();
+    f();
+    return NsToSec(Clock::now() - start);
+}
+
+template <typename PackedT>
+bool Run(const char* label, const vector<uint32_t>& ids, PackedT packed,
+         const vector<size_t>& randomIdx) {
+    const size_t n = ids.size();
+    // first Pack faults the pages in, time the second one
+    packed.Pack(ids);
+    const double tpack = Time([&] { packed.Pack(ids); });
+    // sequential scan: unpack blocks into a small buffer
+    uint64_t sum = 0;
+    const double tscan = Time([&] {
+        const size_t BLOCK = 1024;
+        uint32_t buf[BLOCK];
+        for (size_t i = 0; i < n; i += BLOCK) {
+            const size_t c = min(BLOCK, n - i);
+            packed.Unpack(i, c, buf);
+            for (size_t j = 0; j != c; ++j) sum += buf[j];
+        }
+    });
+    uint64_t rsum = 0;
+    const double trandom = Time([&] {
+        for (size_t i : randomIdx) rsum += packed.Get(i);
+    });
+    uint64_t ref = 0, rref = 0;
+    for (size_t i : randomIdx) rref += ids[i];
+    ref = accumulate(ids.begin(), ids.end(), uint64_t(0));
+    bool ok = sum == ref && rsum == rref;
+    // random writes round trip
+    for (size_t k = 0; k != 1000; ++k) {
+        const size_t i = randomIdx[k];
+        packed.Set(i, ids[(i * 7919) % n]);
+        ok = ok && packed.Get(i) == ids[(i * 7919) % n];
+        packed.Set(i, ids[i]);
+    }
+    ok = ok && packed.Unpack() == ids;
+    cout << "  " << label << packed.Bits() << " bits, "
+         << packed.Bytes() / double(1 << 20) << " MiB, pack "
+         << n * 4 / tpack / 1E9 << " GB/s, scan " << n / tscan / 1E9
+         << " G values/s, random get " << 1E9 * trandom / randomIdx.size()
+         << " ns" << (ok ? "" : " ERROR") << endl;
+    return ok;
+}
+
+//------------------------------------------------------------------------------
+int main(int argc, char const* argv[]) {
+    const size_t n = argc > 1 ? stoull(argv[1]) : size_t(1) << 26;
+    const uint32_t maxId = argc > 2 ? stoul(argv[2]) : 1u << 20;
+    mt19937 gen(3);
+    uniform_int_distribution<uint32_t> dist(0, maxId - 1);
+    vector<uint32_t> ids(n);
+    for (auto& id : ids) id = dist(gen);
+    vector<size_t> randomIdx(size_t(1) << 22);
+    for (auto& i : randomIdx) i = gen() % n;
+
+    // baseline
+    uint64_t sum = 0;
+    const double tscan = Time([&] {
+        for (uint32_t id : ids) sum += id;
+    });
+    uint64_t rsum = 0;
+    const double trandom = Time([&] {
+        for (size_t i : randomIdx) rsum += ids[i];
+    });
+    cout << n << " ids in [0, " << maxId << ")" << endl
+         << "  vector<uint32_t>: " << n * 4 / double(1 << 20) << " MiB, scan "
+         << n / tscan / 1E9 << " G values/s, random get "
+         << 1E9 * trandom / randomIdx.size() << " ns (" << sum + rsum << ")"
+         << endl;
+    const int bits = max(1, MaxBitWidth(ids.data(), n));
+    bool ok = Run("dynamic:  ", ids, DynamicBitPackedVector(0, bits), randomIdx);
+    if (bits == 20) {
+        ok = Run("static:   ", ids, BitPackedVector<20>(), randomIdx) && ok;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,172 @@
+// Author: Ugo Varetto
+// Bit packed vector of unsigned integers stored at exactly BITS bits each,
+// BITS in [1, 32]; BitPackedVector<0> (DynamicBitPackedVector) takes the
+// width at run time.
+// Value i occupies bits [i x BITS, (i + 1) x BITS) of a little endian bit
+// stream: any value is read with a single unaligned 64 bit load at byte
+// offset (i x BITS) / 8, and 8 consecutive values span exactly BITS bytes,
+// which is what the sequential Unpack decodes per step.
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "bit_utils.h"
+
+namespace bit_packed_detail {
+inline uint64_t Load64(const uint8_t* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline void Store64(uint8_t* p, uint64_t v) { std::memcpy(p, &v, sizeof(v)); }
+
+// 8 values of BITS bits from BITS bytes at p, shifts and masks are compile
+// time constants
+template <int BITS>
+inline void Unpack8(const uint8_t* p, uint32_t* out) {
+    constexpr uint64_t MASK = Mask(BITS);
+    for (int j = 0; j != 8; ++j) {
+        const int bit = j * BITS;
+        out[j] = uint32_t((Load64(p + bit / 8) >> (bit % 8)) & MASK);
+    }
+}
+
+template <int BITS>
+void UnpackGroups(const uint8_t* p, std::size_t groups, uint32_t* out) {
+    for (std::size_t g = 0; g + 2 <= groups; g += 2) {
+        Unpack8<BITS>(p, out);
+        Unpack8<BITS>(p + BITS, out + 8);
+        p += 2 * BITS;
+        out += 16;
+    }
+    if (groups % 2) Unpack8<BITS>(p, out);
+}
+
+// runtime width: jump to the compile time width version once per call
+template <int... BITS>
+void UnpackGroupsDispatch(int bits, const uint8_t* p, std::size_t groups,
+                          uint32_t* out, std::integer_sequence<int, BITS...>) {
+    using F = void (*)(const uint8_t*, std::size_t, uint32_t*);
+    static const F TABLE[] = {UnpackGroups<BITS + 1>...};
+    TABLE[bits - 1](p, groups, out);
+}
+}  // namespace bit_packed_detail
+
+//------------------------------------------------------------------------------
+template <int BITS>
+class BitPackedVector {
+    static_assert(BITS >= 0 && BITS <= 32, "1 to 32 bits, 0 for runtime");
+
+   public:
+    using value_type = uint32_t;
+    // compile time width
+    explicit BitPackedVector(std::size_t size = 0) : bits_(BITS), size_(0) {
+        static_assert(BITS > 0, "width required for runtime width vectors");
+        Resize(size);
+    }
+    // runtime width
+    BitPackedVector(std::size_t size, int bits) : bits_(bits), size_(0) {
+        static_assert(BITS == 0, "width is a template parameter");
+        assert(bits > 0 && bits <= 32);
+        Resize(size);
+    }
+    std::size_t Size() const { return size_; }
+    int Bits() const { return BITS ? BITS : bits_; }
+    // bytes used for storage
+    std::size_t Bytes() const { return data_.size(); }
+    const uint8_t* Data() const { return data_.data(); }
+    // new elements are zero
+    void Resize(std::size_t size) {
+        for (std::size_t i = size; i < size_; ++i) Set(i, 0);
+        size_ = size;
+        // 8 bytes of padding: every access is an unaligned 64 bit load
+        data_.resize((size * Bits() + 7) / 8 + sizeof(uint64_t), 0);
+    }
+    uint32_t Get(std::size_t i) const {
+        assert(i < size_);
+        const std::size_t bit = i * Bits();
+        return uint32_t(
+            (bit_packed_detail::Load64(&data_[bit / 8]) >> (bit % 8)) &
+            Mask(Bits()));
+    }
+    uint32_t operator[](std::size_t i) const { return Get(i); }
+    // v must fit in Bits() bits, checked with assert
+    void Set(std::size_t i, uint32_t v) {
+        assert(i < size_);
+        assert(BitWidth(v) <= Bits());
+        const std::size_t bit = i * Bits();
+        const int shift = bit % 8;
+        uint8_t* p = &data_[bit / 8];
+        const uint64_t m = Mask(Bits(), shift);
+        const uint64_t w = bit_packed_detail::Load64(p);
+        bit_packed_detail::Store64(p, (w & ~m) | ((uint64_t(v) << shift) & m));
+    }
+    void PushBack(uint32_t v) {
+        Resize(size_ + 1);
+        Set(size_ - 1, v);
+    }
+    // Replace content with n values, streaming bits through a 64 bit
+    // accumulator and writing whole 32 bit words
+    void Pack(const uint32_t* values, std::size_t n) {
+        size_ = 0;
+        data_.assign((n * Bits() + 7) / 8 + sizeof(uint64_t), 0);
+        size_ = n;
+        // locals: stores through out may alias any member
+        const int bits = Bits();
+        const uint64_t mask = Mask(bits);
+        uint8_t* out = data_.data();
+        uint64_t acc = 0;
+        int filled = 0;
+        for (std::size_t i = 0; i != n; ++i) {
+            assert(BitWidth(values[i]) <= bits);
+            acc |= (values[i] & mask) << filled;
+            filled += bits;
+            if (filled >= 32) {
+                const uint32_t w = uint32_t(acc);
+                std::memcpy(out, &w, sizeof(w));
+                out += sizeof(w);
+                acc >>= 32;
+                filled -= 32;
+            }
+        }
+        for (; filled > 0; filled -= 8, acc >>= 8) *out++ = uint8_t(acc);
+    }
+    void Pack(const std::vector<uint32_t>& values) {
+        Pack(values.data(), values.size());
+    }
+    // Decode count values starting at first into out, 16 values per step
+    // when first is a multiple of 8
+    void Unpack(std::size_t first, std::size_t count, uint32_t* out) const {
+        assert(first + count <= size_);
+        std::size_t i = first;
+        for (; i % 8 && i != first + count; ++i) *out++ = Get(i);
+        const std::size_t groups = (first + count - i) / 8;
+        const uint8_t* p = &data_[i / 8 * Bits()];
+        if constexpr (BITS > 0) {
+            bit_packed_detail::UnpackGroups<BITS>(p, groups, out);
+        } else {
+            bit_packed_detail::UnpackGroupsDispatch(
+                bits_, p, groups, out, std::make_integer_sequence<int, 32>());
+        }
+        out += groups * 8;
+        for (i += groups * 8; i != first + count; ++i) *out++ = Get(i);
+    }
+    std::vector<uint32_t> Unpack() const {
+        std::vector<uint32_t> v(size_);
+        Unpack(0, size_, v.data());
+        return v;
+    }
+
+   private:
+    int bits_;
+    std::size_t size_;
+    std::vector<uint8_t> data_;
+};
+
+using DynamicBitPackedVector = BitPackedVector<0>;
@@ -0,0 +1,152 @@
+//
+// Bit utilities benchmark: builtin clz/bit width/popcount vs one bit at a
+// time loops, batch popcount kernels over a large bitmap
+// Usage: bit_utils [bitmap MiB, default 1024]
+// Author: Ugo Varetto
+//
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bit_utils.h"
+#include "raw_buffer.h"
+
+using namespace std;
+
+using Clock = chrono::high_resolution_clock;
+template <typename TimeDiffNsT>
+constexpr double NsToSec(const TimeDiffNsT& diff) {
+    return double(chrono::duration_cast<chrono::nanoseconds>(diff).count()) /
+           1E9;
+}
+
+//------------------------------------------------------------------------------
+static_assert(CountLeadingZeros(uint32_t(1)) == 31);
+static_assert(CountLeadingZeros(uint8_t(0)) == 8);
+static_assert(CountLeadingZeros(int16_t(-1)) == 0);
+static_assert(CountTrailingZeros(uint64_t(1) << 40) == 40);
+static_assert(PopCount(0xF0F0F0F0F0F0F0F0ull) == 32);
+static_assert(BitWidth(0x7F) == 7);
+static_assert(BitWidth(0u) == 0);
+
+//------------------------------------------------------------------------------
+// Loop based versions, as previously used in variadic-templates.cpp
+int LoopNumBits(const uint32_t i) {
+    uint32_t mask = 1u << 31;
+    int count = 32;
+    while (mask && !(mask & i)) {
+        --count;
+        mask >>= 1;
+    }
+    return count;
+}
+
+int LoopZerobits(const uint32_t n) {
+    int zeros = 0;
+    for (int cnt = 31; cnt >= 0; cnt--) {
+        if (((n >> cnt) & 1) == 0)
+            ++zeros;
+        else
+            break;
+    }
+    return zeros;
+}
+
+uint64_t LoopPopCount(const char* p, size_t size) {
+    uint64_t c = 0;
+    for (size_t i = 0; i != size; ++i) {
+        for (int b = 0; b != 8; ++b) c += (p[i] >> b) & 1;
+    }
+    return c;
+}
+
+template <typename F>
+double Time(F f) {
+    const auto start = Clock::now();
+    f();
+    return NsToSec(Clock::now() - start);
+}
+
+const char* Name(PopCountKernel k) {
+    switch (k) {
+        case PopCountKernel::PORTABLE:
+            return "portable SWAR";
+        case PopCountKernel::POPCNT:
+            return "popcnt";
+        case PopCountKernel::AVX2:
+            return "AVX2 pshufb";
+        case PopCountKernel::AVX512:
+            return "AVX-512 VPOPCNTDQ";
+    }
+    return "";
+}
+
+//------------------------------------------------------------------------------
+int main(int argc, char const* argv[]) {
+    const size_t MiB = argc > 1 ? stoull(argv[1]) : 1024;
+    // single values: random bit widths so the loops can't be predicted
+    const size_t N = size_t(1) << 24;
+    vector<uint32_t> values(N);
+    mt19937 gen(1);
+    for (auto& v : values) v = (gen() | 1) >> (gen() % 32);
+    auto single = [&](const char* label, auto f) {
+        uint64_t sum = 0;
+        const double t = Time([&] {
+            for (uint32_t v : values) sum += f(v);
+        });
+        cout << "  " << label << 1E9 * t / N << " ns/value (" << sum << ")"
+             << endl;
+        return sum;
+    };
+    cout << "single values" << endl;
+    bool ok = single("loop NumBits:       ", LoopNumBits) ==
+              single("BitWidth:           ", [](uint32_t v) {
+                  return BitWidth(v);
+              });
+    ok = single("loop Zerobits:      ", LoopZerobits) ==
+             single("CountLeadingZeros:  ",
+                    [](uint32_t v) { return CountLeadingZeros(v); }) &&
+         ok;
+    cout << "  MaxBitWidth over array: " << MaxBitWidth(values.data(), N)
+         << endl;
+
+    // popcount over a large bitmap
+    RawBuffer bitmap(MiB << 20, 64);
+    if (!bitmap.Size()) {
+        cerr << "cannot allocate " << MiB << " MiB" << endl;
+        return 1;
+    }
+    for (size_t i = 0; i < bitmap.Size(); i += sizeof(uint32_t)) {
+        const uint32_t r = gen();
+        memcpy(bitmap.Data() + i, &r, sizeof(r));
+    }
+    cout << "popcount over " << MiB << " MiB, GB/s" << endl;
+    // bit loop is slow: time it on a slice and scale
+    const size_t slice = min(bitmap.Size(), size_t(64) << 20);
+    uint64_t refSlice = 0;
+    const double tloop =
+        Time([&] { refSlice = LoopPopCount(bitmap.Data(), slice); });
+    cout << "  bit loop:          " << slice / tloop / 1E9 << endl;
+    uint64_t ref = 0;
+    for (PopCountKernel k :
+         {PopCountKernel::PORTABLE, PopCountKernel::POPCNT,
+          PopCountKernel::AVX2, PopCountKernel::AVX512}) {
+        if (!Supported(k)) continue;
+        uint64_t c = 0;
+        const double t = Time(
+            [&] { c = PopCountBytes(bitmap.Data(), bitmap.Size(), k); });
+        if (!ref) ref = c;
+        ok = ok && c == ref &&
+             PopCountBytes(bitmap.Data(), slice, k) == refSlice &&
+             PopCountBytes(bitmap.Data() + 3, 1001, k) ==
+                 LoopPopCount(bitmap.Data() + 3, 1001);
+        cout << "  " << Name(k) << string(19 - strlen(Name(k)), ' ')
+             << bitmap.Size() / t / 1E9 << endl;
+    }
+    cout << (ok ? "results match" : "ERROR: results differ") << endl;
+    return ok ? 0 : 1;
+}
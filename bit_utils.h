@@ -0,0 +1,278 @@
+// Author: Ugo Varetto
+// Bit utilities: count leading/trailing zeros, population count and bit
+// width, constexpr and mapped to single instructions (lzcnt/bsr, tzcnt/bsf,
+// popcnt) through compiler builtins; portable O(log bits) code otherwise.
+// Batch versions over arrays pick AVX-512 VPOPCNTDQ, AVX2 or popcnt at runtime.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BIT_UTILS_X86
+#include <immintrin.h>
+#endif
+
+namespace bit_utils_detail {
+template <typename T>
+using Unsigned = std::make_unsigned_t<T>;
+
+template <typename T>
+constexpr int Bits() {
+    return 8 * int(sizeof(T));
+}
+}  // namespace bit_utils_detail
+
+//------------------------------------------------------------------------------
+// Number of zero bits above the highest set bit, sizeof(T) * 8 if x == 0
+template <typename T>
+constexpr int CountLeadingZeros(const T x) {
+    static_assert(std::is_integral<T>::value && sizeof(T) <= 8);
+    using namespace bit_utils_detail;
+    const Unsigned<T> u = Unsigned<T>(x);
+    if (u == 0) return Bits<T>();
+#if defined(__GNUC__)
+    if constexpr (sizeof(T) <= 4)
+        return __builtin_clz(uint32_t(u)) - (32 - Bits<T>());
+    else
+        return __builtin_clzll(uint64_t(u));
+#else
+    int n = 0;
+    for (int shift = Bits<T>() / 2; shift; shift /= 2) {
+        if (!(u >> (Bits<T>() - n - shift))) n += shift;
+    }
+    return n;
+#endif
+}
+
+// Number of zero bits below the lowest set bit, sizeof(T) * 8 if x == 0
+template <typename T>
+constexpr int CountTrailingZeros(const T x) {
+    static_assert(std::is_integral<T>::value && sizeof(T) <= 8);
+    using namespace bit_utils_detail;
+    Unsigned<T> u = Unsigned<T>(x);
+    if (u == 0) return Bits<T>();
+#if defined(__GNUC__)
+    if constexpr (sizeof(T) <= 4)
+        return __builtin_ctz(uint32_t(u));
+    else
+        return __builtin_ctzll(uint64_t(u));
+#else
+    int n = 0;
+    for (int shift = Bits<T>() / 2; shift; shift /= 2) {
+        const Unsigned<T> m = (Unsigned<T>(1) << shift) - 1;
+        if (!(u & m)) {
+            n += shift;
+            u >>= shift;
+        }
+    }
+    return n;
+#endif
+}
+
+// Number of set bits
+template <typename T>
+constexpr int PopCount(const T x) {
+    static_assert(std::is_integral<T>::value && sizeof(T) <= 8);
+    using namespace bit_utils_detail;
+    const Unsigned<T> u = Unsigned<T>(x);
+#if defined(__GNUC__)
+    if constexpr (sizeof(T) <= 4)
+        return __builtin_popcount(uint32_t(u));
+    else
+        return __builtin_popcountll(uint64_t(u));
+#else
+    // SWAR: sum bits in pairs, nibbles, bytes then add all bytes
+    uint64_t v = u;
+    v = v - ((v >> 1) & 0x5555555555555555);
+    v = (v & 0x3333333333333333) + ((v >> 2) & 0x3333333333333333);
+    v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0F;
+    return int((v * 0x0101010101010101) >> 56);
+#endif
+}
+
+// Number of bits required to represent x: index of highest set bit + 1,
+// 0 if x == 0
+template <typename T>
+constexpr int BitWidth(const T x) {
+    return bit_utils_detail::Bits<T>() - CountLeadingZeros(x);
+}
+
+// bits ones starting at offset: Mask(3, 4) == 0b1110000
+constexpr uint64_t Mask(const int bits, const int offset = 0) {
+    return (bits >= 64 ? ~uint64_t(0) : (uint64_t(1) << bits) - 1) << offset;
+}
+
+//------------------------------------------------------------------------------
+// Batch versions
+enum class PopCountKernel { PORTABLE, POPCNT, AVX2, AVX512 };
+
+// Kernels take a byte pointer with no alignment requirement and a number of
+// 64 bit words
+namespace bit_utils_detail {
+inline uint64_t Load64(const char* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t PopCountPortable(const char* p, std::size_t n) {
+    uint64_t c = 0;
+    for (std::size_t i = 0; i != n; ++i) {
+        uint64_t v = Load64(p + 8 * i);
+        v = v - ((v >> 1) & 0x5555555555555555);
+        v = (v & 0x3333333333333333) + ((v >> 2) & 0x3333333333333333);
+        v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0F;
+        c += (v * 0x0101010101010101) >> 56;
+    }
+    return c;
+}
+
+#ifdef BIT_UTILS_X86
+// four independent accumulators hide popcnt latency
+__attribute__((target("popcnt"))) inline uint64_t PopCountPOPCNT(
+    const char* p, std::size_t n) {
+    uint64_t c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        c0 += __builtin_popcountll(Load64(p + 8 * i));
+        c1 += __builtin_popcountll(Load64(p + 8 * i + 8));
+        c2 += __builtin_popcountll(Load64(p + 8 * i + 16));
+        c3 += __builtin_popcountll(Load64(p + 8 * i + 24));
+    }
+    for (; i != n; ++i) c0 += __builtin_popcountll(Load64(p + 8 * i));
+    return c0 + c1 + c2 + c3;
+}
+
+// Nibble lookup through pshufb, byte counts summed with psadbw every 8
+// iterations (8 x 8 bits max fits a byte)
+__attribute__((target("avx2"))) inline uint64_t PopCountAVX2(const char* p,
+                                                             std::size_t n) {
+    const __m256i LOOKUP =
+        _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1,
+                         1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i LOW = _mm256_set1_epi8(0x0F);
+    __m256i acc = _mm256_setzero_si256();
+    std::size_t i = 0;
+    while (i + 4 <= n) {
+        __m256i bytes = _mm256_setzero_si256();
+        for (int k = 0; k != 8 && i + 4 <= n; ++k, i += 4) {
+            const __m256i v = _mm256_loadu_si256((const __m256i*)(p + 8 * i));
+            const __m256i lo = _mm256_and_si256(v, LOW);
+            const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), LOW);
+            bytes = _mm256_add_epi8(bytes, _mm256_shuffle_epi8(LOOKUP, lo));
+            bytes = _mm256_add_epi8(bytes, _mm256_shuffle_epi8(LOOKUP, hi));
+        }
+        acc = _mm256_add_epi64(acc,
+                               _mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+    }
+    uint64_t c = uint64_t(_mm256_extract_epi64(acc, 0)) +
+                 uint64_t(_mm256_extract_epi64(acc, 1)) +
+                 uint64_t(_mm256_extract_epi64(acc, 2)) +
+                 uint64_t(_mm256_extract_epi64(acc, 3));
+    return c + PopCountPortable(p + 8 * i, n - i);
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq"))) inline uint64_t
+PopCountAVX512(const char* p, std::size_t n) {
+    __m512i a0 = _mm512_setzero_si512(), a1 = _mm512_setzero_si512();
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        a0 = _mm512_add_epi64(
+            a0, _mm512_popcnt_epi64(_mm512_loadu_si512(p + 8 * i)));
+        a1 = _mm512_add_epi64(
+            a1, _mm512_popcnt_epi64(_mm512_loadu_si512(p + 8 * i + 64)));
+    }
+    if (i + 8 <= n) {
+        a0 = _mm512_add_epi64(
+            a0, _mm512_popcnt_epi64(_mm512_loadu_si512(p + 8 * i)));
+        i += 8;
+    }
+    // reduced through memory: _mm512_reduce_add_epi64 and
+    // _mm512_extracti64x4_epi64 warn under -Wall on GCC 12 (uninitialized
+    // __Y in avx512fintrin.h)
+    alignas(64) uint64_t lanes[8];
+    _mm512_store_si512(lanes, _mm512_add_epi64(a0, a1));
+    uint64_t c = 0;
+    for (uint64_t l : lanes) c += l;
+    return c + PopCountPOPCNT(p + 8 * i, n - i);
+}
+#endif
+}  // namespace bit_utils_detail
+
+inline bool Supported(PopCountKernel k) {
+#ifdef BIT_UTILS_X86
+    switch (k) {
+        case PopCountKernel::PORTABLE:
+            return true;
+        case PopCountKernel::POPCNT:
+            return __builtin_cpu_supports("popcnt");
+        case PopCountKernel::AVX2:
+            return __builtin_cpu_supports("avx2");
+        case PopCountKernel::AVX512:
+            return __builtin_cpu_supports("avx512f") &&
+                   __builtin_cpu_supports("avx512vpopcntdq");
+    }
+    return false;
+#else
+    return k == PopCountKernel::PORTABLE;
+#endif
+}
+
+inline PopCountKernel BestPopCountKernel() {
+    static const PopCountKernel best =
+        Supported(PopCountKernel::AVX512)   ? PopCountKernel::AVX512
+        : Supported(PopCountKernel::AVX2)   ? PopCountKernel::AVX2
+        : Supported(PopCountKernel::POPCNT) ? PopCountKernel::POPCNT
+                                            : PopCountKernel::PORTABLE;
+    return best;
+}
+
+namespace bit_utils_detail {
+inline uint64_t PopCountWords(const char* words, std::size_t n,
+                              PopCountKernel k) {
+    switch (k) {
+#ifdef BIT_UTILS_X86
+        case PopCountKernel::AVX512:
+            return PopCountAVX512(words, n);
+        case PopCountKernel::AVX2:
+            return PopCountAVX2(words, n);
+        case PopCountKernel::POPCNT:
+            return PopCountPOPCNT(words, n);
+#endif
+        default:
+            return PopCountPortable(words, n);
+    }
+}
+}  // namespace bit_utils_detail
+
+// Number of set bits in n 64 bit words
+inline uint64_t PopCount(const uint64_t* words, std::size_t n,
+                         PopCountKernel k = BestPopCountKernel()) {
+    return bit_utils_detail::PopCountWords(
+        reinterpret_cast<const char*>(words), n, k);
+}
+
+// Number of set bits in a byte buffer of any size and alignment
+inline uint64_t PopCountBytes(const void* data, std::size_t size,
+                              PopCountKernel k = BestPopCountKernel()) {
+    const char* p = static_cast<const char*>(data);
+    const std::size_t words = size / sizeof(uint64_t);
+    uint64_t c = bit_utils_detail::PopCountWords(p, words, k);
+    for (std::size_t i = words * sizeof(uint64_t); i != size; ++i)
+        c += PopCount(uint8_t(p[i]));
+    return c;
+}
+
+// Bit width of the largest value: number of bits needed to store every
+// element, the OR reduction vectorizes without intrinsics
+template <typename T>
+int MaxBitWidth(const T* values, std::size_t n) {
+    static_assert(std::is_integral<T>::value);
+    bit_utils_detail::Unsigned<T> acc = 0;
+    for (std::size_t i = 0; i != n; ++i)
+        acc |= bit_utils_detail::Unsigned<T>(values[i]);
+    return BitWidth(acc);
+}
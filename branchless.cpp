@@ -1,28 +1,195 @@
+//
+// Branch vs branchless selection: if/else, ternary, cmov, lookup table,
+// function pointer table and arithmetic masking over input streams with
+// 0% to 100% random outcomes; reports ns/op and branch misses/op (when
+// hardware counters are available)
+// Usage: branchless [num values, default 2^22] [repetitions, default 8]
+// Author: Ugo Varetto
+//
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
 #include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "perf_counter.h"
 
 using namespace std;
 
-#ifdef BL
-void Foo(int i) {
+using Clock = chrono::high_resolution_clock;
+template <typename TimeDiffNsT>
+constexpr double NsToSec(const TimeDiffNsT& diff) {
+    return double(chrono::duration_cast<chrono::nanoseconds>(diff).count()) /
+           1E9;
+}
+
+//------------------------------------------------------------------------------
+// Original example: if/else vs table of functions indexed by the condition
+void FooBranch(int i) {
+    if (i < 10) {
+        cout << i << " < 10" << endl;
+    } else {
+        cout << i << " >= 10" << endl;
+    }
+}
+
+void FooTable(int i) {
     using F = void (*)(int);
     struct __ {
         static void True(int i) { cout << i << " < 10" << endl; }
         static void False(int i) { cout << i << " >= 10" << endl; }
     };
-    static const F condition[] = {__::True, __::False};
-    condition[i < 0](i);
+    // indexed by the condition: false first
+    static const F condition[] = {__::False, __::True};
+    condition[i < 10](i);
 }
-#else
-void Foo(int i) {
-    if(i<10) { cout << i << " < 10" << endl; }
-    else { cout << i << " >= 10" << endl; }
+
+int Gen(int g) { return g / 4; }
+
+//------------------------------------------------------------------------------
+// Same selection with each pattern: x < 10 ? 3x : -x, summed.
+// No vectorization: measure the scalar selection, not SIMD blends.
+#define SCALAR __attribute__((optimize("no-tree-vectorize")))
+
+SCALAR int64_t Branch(const int* v, size_t n) {
+    int64_t s = 0;
+    for (size_t i = 0; i != n; ++i) {
+        const int x = v[i];
+        // empty asm keeps the compiler from turning the branch into a cmov
+        if (x < 10) {
+            asm volatile("");
+            s += 3 * x;
+        } else {
+            asm volatile("");
+            s -= x;
+        }
+    }
+    return s;
+}
+
+// the compiler decides between branch and cmov: GCC keeps the branch
+SCALAR int64_t Ternary(const int* v, size_t n) {
+    int64_t s = 0;
+    for (size_t i = 0; i != n; ++i) {
+        const int x = v[i];
+        s += x < 10 ? 3 * x : -x;
+    }
+    return s;
 }
+
+// c ? a : b, always a conditional move on x86
+inline int Select(int c, int a, int b) {
+#if defined(__x86_64__) || defined(__i386__)
+    asm("test %1, %1\n\tcmovz %2, %0" : "+r"(a) : "r"(c), "r"(b) : "cc");
+    return a;
+#else
+    return c ? a : b;
 #endif
-int Gen(int g) {
-    return g / 4;
-}
-int main(int argc, char const *argv[]) {
-    
-    Foo(Gen(9));
-    return 0;
-}
\ No newline at end of file
+}
+
+SCALAR int64_t Cmov(const int* v, size_t n) {
+    int64_t s = 0;
+    for (size_t i = 0; i != n; ++i) {
+        const int x = v[i];
+        s += Select(x < 10, 3 * x, -x);
+    }
+    return s;
+}
+
+SCALAR int64_t LookupTable(const int* v, size_t n) {
+    static const int MUL[] = {-1, 3};
+    int64_t s = 0;
+    for (size_t i = 0; i != n; ++i) s += v[i] * MUL[v[i] < 10];
+    return s;
+}
+
+__attribute__((noinline)) int Triple(int x) { return 3 * x; }
+__attribute__((noinline)) int Negate(int x) { return -x; }
+
+SCALAR int64_t FunctionTable(const int* v, size_t n) {
+    using F = int (*)(int);
+    static const F OPS[] = {Negate, Triple};
+    int64_t s = 0;
+    for (size_t i = 0; i != n; ++i) s += OPS[v[i] < 10](v[i]);
+    return s;
+}
+
+SCALAR int64_t Mask(const int* v, size_t n) {
+    int64_t s = 0;
+    for (size_t i = 0; i != n; ++i) {
+        const int x = v[i];
+        const int m = -int(x < 10);
+        s += (3 * x & m) | (-x & ~m);
+    }
+    return s;
+}
+
+//------------------------------------------------------------------------------
+// Runs of 16 values below/above threshold, a fraction of them replaced by
+// random outcomes
+vector<int> Input(size_t n, double random, mt19937& gen) {
+    vector<int> v(n);
+    uniform_real_distribution<double> coin(0, 1);
+    for (size_t i = 0; i != n; ++i) {
+        const bool below =
+            coin(gen) < random ? coin(gen) < 0.5 : (i / 16) % 2 == 0;
+        v[i] = int(gen() % 10) + (below ? 0 : 10);
+    }
+    return v;
+}
+
+struct Variant {
+    const char* name;
+    int64_t (*f)(const int*, size_t);
+};
+
+//------------------------------------------------------------------------------
+int main(int argc, char const* argv[]) {
+    FooBranch(Gen(9));
+    FooTable(Gen(9));
+    FooTable(Gen(40));
+    const size_t n = argc > 1 ? stoull(argv[1]) : size_t(1) << 22;
+    const int reps = argc > 2 ? stoi(argv[2]) : 8;
+    const Variant variants[] = {{"branch", Branch},
+                                {"ternary", Ternary},
+                                {"cmov", Cmov},
+                                {"lookup", LookupTable},
+                                {"fn table", FunctionTable},
+                                {"mask", Mask}};
+    PerfCounter misses(PerfEvent::BRANCH_MISSES);
+    cout << "ns/op" << (misses.Valid() ? ", branch misses/op" : "")
+         << " (branch miss counter "
+         << (misses.Valid() ? "enabled" : "not available") << ")" << endl
+         << "random";
+    for (const Variant& v : variants) cout << setw(20) << v.name;
+    cout << endl;
+    mt19937 gen(1);
+    bool ok = true;
+    for (int percent : {0, 1, 5, 10, 25, 50, 75, 100}) {
+        const vector<int> in = Input(n, percent / 100.0, gen);
+        cout << setw(5) << percent << '%';
+        int64_t ref = 0;
+        for (const Variant& v : variants) {
+            int64_t s = 0;
+            misses.Start();
+            const auto start = Clock::now();
+            for (int r = 0; r != reps; ++r) s = v.f(in.data(), n);
+            const double t = NsToSec(Clock::now() - start);
+            const uint64_t m = misses.Stop();
+            if (&v == variants) ref = s;
+            ok = ok && s == ref;
+            cout << setw(11) << setprecision(3) << 1E9 * t / (n * reps);
+            if (misses.Valid()) {
+                cout << setw(9) << setprecision(2) << double(m) / (n * reps);
+            } else {
+                cout << setw(9) << '-';
+            }
+        }
+        cout << endl;
+    }
+    cout << (ok ? "results match" : "ERROR: results differ") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,148 @@
+//
+// Element-wise expressions with 2 to 6 operands over float columns: eager
+// vector operators (one temporary and one pass per operator, temporaries
+// reused when they are rvalues), lazy expression templates (one pass, no
+// temporaries) and a hand written loop, ms per evaluation
+// Usage: column_expr [number of elements, default 10^8]
+// Author: Ugo Varetto
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "column_expr.h"
+
+using namespace std;
+
+using Clock = chrono::high_resolution_clock;
+template <typename TimeDiffNsT>
+constexpr double NsToSec(const TimeDiffNsT& diff) {
+    return double(chrono::duration_cast<chrono::nanoseconds>(diff).count()) /
+           1E9;
+}
+
+//------------------------------------------------------------------------------
+// eager operators
+using Vec = vector<float>;
+
+template <typename OpF>
+Vec Eager(const Vec& l, const Vec& r, OpF op) {
+    Vec v(l.size());
+    for (size_t i = 0; i != v.size(); ++i) v[i] = op(l[i], r[i]);
+    return v;
+}
+template <typename OpF>
+Vec Eager(Vec&& l, const Vec& r, OpF op) {
+    for (size_t i = 0; i != l.size(); ++i) l[i] = op(l[i], r[i]);
+    return std::move(l);
+}
+
+Vec operator+(const Vec& l, const Vec& r) { return Eager(l, r, plus<>()); }
+Vec operator-(const Vec& l, const Vec& r) { return Eager(l, r, minus<>()); }
+Vec operator*(const Vec& l, const Vec& r) {
+    return Eager(l, r, multiplies<>());
+}
+Vec operator+(Vec&& l, const Vec& r) {
+    return Eager(std::move(l), r, plus<>());
+}
+Vec operator-(Vec&& l, const Vec& r) {
+    return Eager(std::move(l), r, minus<>());
+}
+Vec operator*(Vec&& l, const Vec& r) {
+    return Eager(std::move(l), r, multiplies<>());
+}
+
+//------------------------------------------------------------------------------
+// ms
+template <typename F>
+double Time(F f) {
+    const auto start = Clock::now();
+    f();
+    return 1E3 * NsToSec(Clock::now() - start);
+}
+
+// expr is called with vectors, columns and floats
+template <typename ExprF>
+bool Bench(int operands, const vector<Vec>& x, ExprF expr) {
+    // the hand written loop overwrites the eager result, two results alive
+    // at a time
+    Vec eager;
+    const double te = Time([&]() {
+        eager = expr(x[0], x[1], x[2], x[3], x[4], x[5]);
+    });
+    Vec lazy(x[0].size());
+    const double tl = Time([&]() {
+        Col(lazy) = expr(Col(x[0]), Col(x[1]), Col(x[2]), Col(x[3]),
+                         Col(x[4]), Col(x[5]));
+    });
+    bool ok = eager == lazy;
+    Vec& loop = eager;
+    fill(begin(loop), end(loop), 0.f);
+    const double th = Time([&]() {
+        for (size_t i = 0; i != loop.size(); ++i) {
+            loop[i] = expr(x[0][i], x[1][i], x[2][i], x[3][i], x[4][i],
+                           x[5][i]);
+        }
+    });
+    ok = ok && loop == lazy;
+    cout << setw(9) << operands << setw(10) << te << setw(10) << tl
+         << setw(10) << th << endl;
+    return ok;
+}
+
+//------------------------------------------------------------------------------
+int main(int argc, char const* argv[]) {
+    const size_t n = argc > 1 ? stoull(argv[1]) : size_t(100'000'000);
+    // interface
+    {
+        Vec a = {1, 2, 3}, b = {4, 5, 6}, c(3);
+        const Vec k = {1, 1, 1};
+        Col(c) = 2.f * Col(a) - Col(b) / 2.f + Col(k);
+        Col(c) += -Map([](float u, float v) { return max(u, v); }, Col(a),
+                       Col(b));
+        if (c != Vec{-3.f, -2.5f, -2.f}) {
+            cerr << "ERROR: wrong expression" << endl;
+            return 1;
+        }
+    }
+    mt19937 gen(1);
+    uniform_real_distribution<float> dist(-1.f, 1.f);
+    vector<Vec> x(6, Vec(n));
+    for (auto& v : x) generate(begin(v), end(v), [&]() { return dist(gen); });
+    cout << setprecision(3) << "ms, " << n << " elements" << endl
+         << " operands     eager      lazy      loop" << endl;
+    bool ok = Bench(2, x, [](const auto& a, const auto& b, const auto&,
+                             const auto&, const auto&, const auto&) {
+        return a * b;
+    });
+    ok = Bench(3, x,
+               [](const auto& a, const auto& b, const auto& c, const auto&,
+                  const auto&, const auto&) { return a * b + c; }) &&
+         ok;
+    ok = Bench(4, x,
+               [](const auto& a, const auto& b, const auto& c,
+                  const auto& d, const auto&, const auto&) {
+                   return a * b + c * d;
+               }) &&
+         ok;
+    ok = Bench(5, x,
+               [](const auto& a, const auto& b, const auto& c,
+                  const auto& d, const auto& e, const auto&) {
+                   return a * b + c * d - e;
+               }) &&
+         ok;
+    ok = Bench(6, x,
+               [](const auto& a, const auto& b, const auto& c,
+                  const auto& d, const auto& e, const auto& f) {
+                   return (a * b + c * d - e) * f;
+               }) &&
+         ok;
+    cout << (ok ? "results match" : "ERROR: results differ") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+// Author: Ugo Varetto
+// Lazy element-wise arithmetic over contiguous columns (expression
+// templates): operators on columns and scalars build an expression tree,
+// assigning the expression to a column evaluates it in a single loop with no
+// temporary columns, which the compiler inlines and vectorizes.
+// Nodes are n-ary: MapExpr<F, Args...> applies F to the i-th element of each
+// operand, expanding the operand pack as Zipper does with its iterators;
+// Map(f, exprs...) builds custom nodes. Operands are held by value, columns
+// are views (pointer and size) of data owned elsewhere.
+// Operand sizes must match, checked with assert.
+//   Col(c) = Col(a) * Col(b) + Col(d);
+//   Col(c) += 0.5f * Map([](float x, float y) { return x < y ? x : y; },
+//                         Col(a), Col(b));
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace column_expr_detail {
+// size of scalar operands
+constexpr std::size_t ANY = ~std::size_t(0);
+
+// common size of operands, ANY if all scalar
+template <typename... SizeT>
+std::size_t CommonSize(SizeT... sizes) {
+    std::size_t s = ANY;
+    ((s = s == ANY ? sizes : s), ...);
+    assert((... && (sizes == ANY || sizes == s)));
+    return s;
+}
+}  // namespace column_expr_detail
+
+// Base of all expressions, E is the derived type
+template <typename E>
+struct Expr {
+    const E& Self() const { return static_cast<const E&>(*this); }
+};
+
+template <typename T>
+class ScalarExpr : public Expr<ScalarExpr<T>> {
+   public:
+    using value_type = T;
+    ScalarExpr(T v) : v_(v) {}
+    T operator[](std::size_t) const { return v_; }
+    std::size_t Size() const { return column_expr_detail::ANY; }
+
+   private:
+    T v_;
+};
+
+template <typename F, typename... ArgsT>
+class MapExpr : public Expr<MapExpr<F, ArgsT...>> {
+   private:
+    using Indices = std::make_index_sequence<sizeof...(ArgsT)>;
+
+   public:
+    using value_type =
+        std::decay_t<decltype(std::declval<const F&>()(
+            std::declval<typename ArgsT::value_type>()...))>;
+    MapExpr(F f, ArgsT... args) : f_(f), args_(args...) {}
+    value_type operator[](std::size_t i) const { return At(i, Indices{}); }
+    std::size_t Size() const { return Size(Indices{}); }
+
+   private:
+    template <std::size_t... I>
+    value_type At(std::size_t i, const std::index_sequence<I...>&) const {
+        return f_(std::get<I>(args_)[i]...);
+    }
+    template <std::size_t... I>
+    std::size_t Size(const std::index_sequence<I...>&) const {
+        return column_expr_detail::CommonSize(std::get<I>(args_).Size()...);
+    }
+
+   private:
+    F f_;
+    std::tuple<ArgsT...> args_;
+};
+
+template <typename T>
+class Column : public Expr<Column<T>> {
+   public:
+    using value_type = std::remove_const_t<T>;
+    Column(T* data, std::size_t size) : data_(data), size_(size) {}
+    Column(const Column&) = default;
+    T& operator[](std::size_t i) const { return data_[i]; }
+    std::size_t Size() const { return size_; }
+    T* Data() const { return data_; }
+
+    // evaluation: one pass over all the operands
+    template <typename E>
+    Column& operator=(const Expr<E>& e) {
+        return Assign(e.Self(), [](T& d, const auto& v) { d = v; });
+    }
+    // assigns elements, does not rebind the view
+    Column& operator=(const Column& c) {
+        return Assign(c, [](T& d, const auto& v) { d = v; });
+    }
+    template <typename E>
+    Column& operator+=(const Expr<E>& e) {
+        return Assign(e.Self(), [](T& d, const auto& v) { d += v; });
+    }
+    template <typename E>
+    Column& operator-=(const Expr<E>& e) {
+        return Assign(e.Self(), [](T& d, const auto& v) { d -= v; });
+    }
+    template <typename E>
+    Column& operator*=(const Expr<E>& e) {
+        return Assign(e.Self(), [](T& d, const auto& v) { d *= v; });
+    }
+
+   private:
+    template <typename E, typename OpF>
+    Column& Assign(const E& e, OpF op) {
+        static_assert(!std::is_const<T>::value, "assignment to const column");
+        assert(e.Size() == column_expr_detail::ANY || e.Size() == size_);
+        // local copy: stores to data_ cannot change the operand pointers,
+        // which stay in registers
+        const E x = e;
+        for (std::size_t i = 0; i != size_; ++i) op(data_[i], x[i]);
+        return *this;
+    }
+
+   private:
+    T* data_;
+    std::size_t size_;
+};
+
+// Column view of a contiguous container with data() and size()
+template <typename C>
+auto Col(C& c) {
+    using T = std::remove_reference_t<decltype(*c.data())>;
+    return Column<T>(c.data(), c.size());
+}
+
+template <typename F, typename... ArgsT>
+MapExpr<F, ArgsT...> Map(F f, const Expr<ArgsT>&... args) {
+    return MapExpr<F, ArgsT...>(f, args.Self()...);
+}
+
+//------------------------------------------------------------------------------
+// Operators: expression op expression, expression op scalar, scalar op
+// expression
+#define COLUMN_EXPR_OPERATOR(OP, FUN)                                       \
+    template <typename L, typename R>                                       \
+    MapExpr<FUN, L, R> operator OP(const Expr<L>& l, const Expr<R>& r) {    \
+        return MapExpr<FUN, L, R>(FUN(), l.Self(), r.Self());               \
+    }                                                                       \
+    template <typename L, typename S,                                       \
+              typename = std::enable_if_t<std::is_arithmetic<S>::value>>    \
+    MapExpr<FUN, L, ScalarExpr<S>> operator OP(const Expr<L>& l, S s) {     \
+        return MapExpr<FUN, L, ScalarExpr<S>>(FUN(), l.Self(), s);          \
+    }                                                                       \
+    template <typename S, typename R,                                       \
+              typename = std::enable_if_t<std::is_arithmetic<S>::value>>    \
+    MapExpr<FUN, ScalarExpr<S>, R> operator OP(S s, const Expr<R>& r) {     \
+        return MapExpr<FUN, ScalarExpr<S>, R>(FUN(), s, r.Self());          \
+    }
+
+COLUMN_EXPR_OPERATOR(+, std::plus<>)
+COLUMN_EXPR_OPERATOR(-, std::minus<>)
+COLUMN_EXPR_OPERATOR(*, std::multiplies<>)
+COLUMN_EXPR_OPERATOR(/, std::divides<>)
+
+#undef COLUMN_EXPR_OPERATOR
+
+template <typename E>
+MapExpr<std::negate<>, E> operator-(const Expr<E>& e) {
+    return MapExpr<std::negate<>, E>(std::negate<>(), e.Self());
+}
@@ -0,0 +1,191 @@
+//
+// Block compressed buffers: compression ratio, compression and full
+// decompression throughput (GB/s of uncompressed data) and latency of
+// random block accesses missing the decompressed block cache, for service
+// log text, an int32 column of timestamps, a float column of sensor
+// readings and random bytes
+// Usage: compressed_buffer [size in MiB, default 256] [block size in KiB,
+//                          default 64] [threads, default all cores]
+// Author: Ugo Varetto
+//
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "compressed_buffer.h"
+#include "raw_buffer.h"
+
+using namespace std;
+
+using Clock = chrono::high_resolution_clock;
+template <typename TimeDiffNsT>
+constexpr double NsToSec(const TimeDiffNsT& diff) {
+    return double(chrono::duration_cast<chrono::nanoseconds>(diff).count()) /
+           1E9;
+}
+
+//------------------------------------------------------------------------------
+// data sets
+void Log(RawBuffer& b) {
+    const char* levels[] = {"INFO ", "INFO ", "INFO ", "DEBUG", "WARN "};
+    const char* paths[] = {"/api/v1/items/", "/api/v1/users/",
+                           "/api/v2/orders/", "/static/img/"};
+    const int status[] = {200, 200, 200, 200, 304, 404, 500};
+    mt19937 gen(1);
+    uint64_t ms = 1700000000000;
+    char line[256];
+    size_t i = 0;
+    while (i < b.Size()) {
+        ms += gen() % 20;
+        const int n = snprintf(
+            line, sizeof(line),
+            "%llu.%03llu %s [worker-%u] GET %s%u status=%d latency_us=%u\n",
+            (unsigned long long)(ms / 1000), (unsigned long long)(ms % 1000),
+            levels[gen() % 5], unsigned(gen() % 16), paths[gen() % 4],
+            unsigned(gen() % 100000), status[gen() % 7],
+            unsigned(100 + gen() % 50000));
+        const size_t len = min(size_t(n), b.Size() - i);
+        memcpy(b.Data() + i, line, len);
+        i += len;
+    }
+}
+
+void Timestamps(RawBuffer& b) {
+    mt19937 gen(2);
+    int32_t t = 1700000000;
+    for (size_t i = 0; i + 4 <= b.Size(); i += 4) {
+        t += gen() % 4 == 0;
+        memcpy(b.Data() + i, &t, 4);
+    }
+}
+
+void Sensor(RawBuffer& b) {
+    mt19937 gen(3);
+    normal_distribution<float> noise(0.f, 0.05f);
+    for (size_t i = 0; i + 4 <= b.Size(); i += 4) {
+        // readings rounded to 0.01: few distinct values
+        const float x = 20.f + 5.f * sin(i * 1E-6f) + noise(gen);
+        const float v = round(x * 100.f) / 100.f;
+        memcpy(b.Data() + i, &v, 4);
+    }
+}
+
+void Random(RawBuffer& b) {
+    mt19937_64 gen(4);
+    for (size_t i = 0; i + 8 <= b.Size(); i += 8) {
+        const uint64_t v = gen();
+        memcpy(b.Data() + i, &v, 8);
+    }
+}
+
+//------------------------------------------------------------------------------
+bool Bench(const string& label, const RawBuffer& src, size_t blockSize,
+           unsigned threads, size_t accesses) {
+    auto start = Clock::now();
+    CompressedBuffer cb(src, blockSize, 8, threads);
+    const double compress = NsToSec(Clock::now() - start);
+    if (cb.Size() != src.Size()) {
+        cerr << "ERROR: allocation failed" << endl;
+        return false;
+    }
+    RawBuffer out(src.Size());
+    memset(out.Data(), 0, out.Size());
+    start = Clock::now();
+    bool ok = cb.Decompress(out.Data(), threads);
+    const double decompress = NsToSec(Clock::now() - start);
+    ok = ok && memcmp(out.Data(), src.Data(), src.Size()) == 0;
+    // random blocks, cache misses but for 8 in NumBlocks()
+    mt19937_64 gen(5);
+    vector<size_t> blocks(accesses);
+    for (auto& i : blocks) i = gen() % cb.NumBlocks();
+    uint64_t check = 0;
+    start = Clock::now();
+    for (size_t i : blocks) {
+        const char* b = cb.Block(i);
+        check += b ? uint8_t(b[(i * 7) % cb.BlockLength(i)]) : 0;
+    }
+    const double latency = 1E6 * NsToSec(Clock::now() - start) / accesses;
+    uint64_t expected = 0;
+    for (size_t i : blocks) {
+        expected += uint8_t(src.Data()[i * blockSize + (i * 7) %
+                                                       cb.BlockLength(i)]);
+    }
+    ok = ok && check == expected;
+    // reads across block boundaries
+    char buf[4096];
+    for (int r = 0; r != 1000 && ok; ++r) {
+        const size_t n = gen() % sizeof(buf);
+        const size_t offset = gen() % (src.Size() - n);
+        ok = cb.Read(offset, n, buf) &&
+             memcmp(buf, src.Data() + offset, n) == 0;
+    }
+    const double gb = src.Size() / 1E9;
+    cout << setw(12) << label << setw(8) << double(src.Size()) /
+                                                cb.CompressedSize()
+         << setw(12) << gb / compress << setw(14) << gb / decompress
+         << setw(10) << latency << endl;
+    return ok;
+}
+
+//------------------------------------------------------------------------------
+int main(int argc, char const* argv[]) {
+    const size_t size = (argc > 1 ? stoull(argv[1]) : 256) << 20;
+    const size_t blockSize = (argc > 2 ? stoull(argv[2]) : 64) << 10;
+    const unsigned threads =
+        argc > 3 ? stoul(argv[3]) : compressed_buffer_detail::DefaultThreads();
+    // codec edge cases
+    bool ok = true;
+    for (const string s :
+         {"", "a", "abcd", "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa",
+          "abcabcabcabcabcabcabcabcabcabcabcabcabcabcabcabcabcabcabcx"}) {
+        char c[128];
+        char d[128];
+        const size_t n = LZCompress(s.data(), s.size(), c, sizeof(c));
+        ok = ok && n && LZDecompress(c, n, d, s.size()) &&
+             memcmp(d, s.data(), s.size()) == 0;
+    }
+    if (!ok) {
+        cerr << "ERROR: codec round trip" << endl;
+        return 1;
+    }
+    // no cached blocks requested: one is cached; zero block size rejected
+    {
+        RawBuffer small(5 * 4096);
+        for (size_t i = 0; i != small.Size(); ++i) small[i] = char(i / 7);
+        CompressedBuffer none(small, 4096, 0, 1);
+        const char* b = none.Block(3);
+        if (none.CachedBlocks() != 1 || !b ||
+            memcmp(b, small.Data() + 3 * 4096, 4096) != 0 ||
+            CompressedBuffer(small, 0).Size() != 0) {
+            cerr << "ERROR: wrong block" << endl;
+            return 1;
+        }
+    }
+    cout << setprecision(3) << (size >> 20) << " MiB, " << (blockSize >> 10)
+         << " KiB blocks, " << threads << " threads" << endl
+         << "        data   ratio  compr GB/s  decompr GB/s  block us"
+         << endl;
+    RawBuffer src(size);
+    if (!src.Size()) {
+        cerr << "ERROR: allocation failed" << endl;
+        return 1;
+    }
+    const size_t accesses = 10000;
+    Log(src);
+    ok = Bench("log", src, blockSize, threads, accesses) && ok;
+    Timestamps(src);
+    ok = Bench("timestamps", src, blockSize, threads, accesses) && ok;
+    Sensor(src);
+    ok = Bench("sensor", src, blockSize, threads, accesses) && ok;
+    Random(src);
+    ok = Bench("random", src, blockSize, threads, accesses) && ok;
+    cout << (ok ? "results match" : "ERROR: results differ") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,192 @@
+// Author: Ugo Varetto
+// Compressed copy of a RawBuffer for data that is rarely accessed: the
+// buffer is split into fixed size blocks, each compressed independently with
+// the LZ codec in lz.h, in parallel; blocks that do not compress are stored
+// as they are.
+// Blocks are decompressed on access into a small cache of the last
+// CachedBlocks() blocks used (least recently used replacement), a pointer
+// returned by Block() stays valid until that many other blocks are
+// accessed; at least one block is cached. Access is not thread safe,
+// Decompress() is.
+// Compression needs a temporary buffer of the source size; as for RawBuffer
+// a zero Size() after construction from a non empty buffer means allocation
+// failure, or a zero block size.
+//   CompressedBuffer cold(buffer);   // then release buffer
+//   const char* b = cold.Block(offset / cold.BlockSize());
+//   cold.Read(offset, n, dest);
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "growable_buffer.h"
+#include "lz.h"
+#include "raw_buffer.h"
+
+namespace compressed_buffer_detail {
+// calls f(i) for i in [0, count) from up to threads threads
+template <typename F>
+void ParallelFor(std::size_t count, unsigned threads, F f) {
+    std::atomic<std::size_t> next(0);
+    auto work = [&]() {
+        for (std::size_t i = next++; i < count; i = next++) f(i);
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads && t < count; ++t) pool.emplace_back(work);
+    work();
+    for (auto& t : pool) t.join();
+}
+
+inline unsigned DefaultThreads() {
+    const unsigned n = std::thread::hardware_concurrency();
+    return n ? n : 1;
+}
+}  // namespace compressed_buffer_detail
+
+class CompressedBuffer {
+   public:
+    static constexpr std::size_t NONE = ~std::size_t(0);
+
+    CompressedBuffer(
+        const RawBuffer& src, std::size_t blockSize = 64 << 10,
+        std::size_t cachedBlocks = 8,
+        unsigned threads = compressed_buffer_detail::DefaultThreads())
+        // blockSize == 0 is rejected with a zero Size()
+        : size_(blockSize ? src.Size() : 0),
+          blockSize_(std::max<std::size_t>(blockSize, 1)),
+          offsets_(NumBlocks() + 1, 0),
+          cache_(std::max<std::size_t>(cachedBlocks, 1) * blockSize_),
+          tags_(std::max<std::size_t>(cachedBlocks, 1), NONE),
+          lastUse_(std::max<std::size_t>(cachedBlocks, 1), 0),
+          tick_(0) {
+        if (!Compress(src, threads)) size_ = 0;
+    }
+    CompressedBuffer(const CompressedBuffer&) = delete;
+    CompressedBuffer& operator=(const CompressedBuffer&) = delete;
+    CompressedBuffer(CompressedBuffer&&) = default;
+    // uncompressed size
+    std::size_t Size() const { return size_; }
+    std::size_t CompressedSize() const { return data_.Size(); }
+    std::size_t BlockSize() const { return blockSize_; }
+    std::size_t NumBlocks() const {
+        return (size_ + blockSize_ - 1) / blockSize_;
+    }
+    std::size_t CachedBlocks() const { return tags_.size(); }
+    // bytes in block i, BlockSize() except for the last block
+    std::size_t BlockLength(std::size_t i) const {
+        const std::size_t b = i * blockSize_;
+        return size_ - b < blockSize_ ? size_ - b : blockSize_;
+    }
+
+    // decompressed block i, nullptr if the compressed data is corrupt
+    const char* Block(std::size_t i) {
+        ++tick_;
+        std::size_t lru = 0;
+        for (std::size_t s = 0; s != tags_.size(); ++s) {
+            if (tags_[s] == i) {
+                lastUse_[s] = tick_;
+                return cache_.Data() + s * blockSize_;
+            }
+            if (lastUse_[s] < lastUse_[lru]) lru = s;
+        }
+        char* dest = cache_.Data() + lru * blockSize_;
+        tags_[lru] = NONE;
+        if (!Decompress(i, dest)) return nullptr;
+        tags_[lru] = i;
+        lastUse_[lru] = tick_;
+        return dest;
+    }
+    // copies bytes [offset, offset + n) to dest through the block cache
+    bool Read(std::size_t offset, std::size_t n, void* dest) {
+        if (offset > size_ || n > size_ - offset) return false;
+        char* d = static_cast<char*>(dest);
+        while (n) {
+            const std::size_t i = offset / blockSize_;
+            const std::size_t b = offset - i * blockSize_;
+            const std::size_t len = BlockLength(i) - b < n ? BlockLength(i) - b
+                                                           : n;
+            const char* block = Block(i);
+            if (!block) return false;
+            std::memcpy(d, block + b, len);
+            d += len;
+            offset += len;
+            n -= len;
+        }
+        return true;
+    }
+    // decompresses all blocks into dest, which must hold Size() bytes,
+    // bypassing the cache
+    bool Decompress(
+        char* dest,
+        unsigned threads = compressed_buffer_detail::DefaultThreads()) const {
+        std::atomic<bool> ok(true);
+        compressed_buffer_detail::ParallelFor(
+            NumBlocks(), threads, [&](std::size_t i) {
+                if (!Decompress(i, dest + i * blockSize_)) ok = false;
+            });
+        return ok;
+    }
+
+   private:
+    bool Decompress(std::size_t i, char* dest) const {
+        const char* p = data_.Data() + offsets_[i];
+        const std::size_t n = offsets_[i + 1] - offsets_[i];
+        const std::size_t len = BlockLength(i);
+        if (n == len) {
+            std::memcpy(dest, p, len);
+            return true;
+        }
+        return LZDecompress(p, n, dest, len);
+    }
+    // each block is compressed to its offset in a temporary buffer, then
+    // the compressed blocks are packed
+    bool Compress(const RawBuffer& src, unsigned threads) {
+        using compressed_buffer_detail::ParallelFor;
+        if (!size_) return true;
+        if (cache_.Size() != tags_.size() * blockSize_) return false;
+        RawBuffer tmp(size_);
+        if (!tmp.Size()) return false;
+        const std::size_t blocks = NumBlocks();
+        std::vector<std::size_t> sizes(blocks);
+        ParallelFor(blocks, threads, [&](std::size_t i) {
+            const std::size_t len = BlockLength(i);
+            const char* in = src.Data() + i * blockSize_;
+            char* out = tmp.Data() + i * blockSize_;
+            // stored if compression does not save anything
+            sizes[i] = LZCompress(in, len, out, len - 1);
+            if (!sizes[i]) {
+                std::memcpy(out, in, len);
+                sizes[i] = len;
+            }
+        });
+        for (std::size_t i = 0; i != blocks; ++i) {
+            offsets_[i + 1] = offsets_[i] + sizes[i];
+        }
+        if (!data_.Resize(offsets_[blocks]) || !data_.ShrinkToFit()) {
+            return false;
+        }
+        ParallelFor(blocks, threads, [&](std::size_t i) {
+            std::memcpy(data_.Data() + offsets_[i],
+                        tmp.Data() + i * blockSize_, sizes[i]);
+        });
+        return true;
+    }
+
+   private:
+    std::size_t size_;
+    std::size_t blockSize_;
+    // compressed block i is [offsets_[i], offsets_[i + 1]) in data_, stored
+    // uncompressed if its size equals BlockLength(i)
+    std::vector<std::size_t> offsets_;
+    GrowableBuffer data_;
+    RawBuffer cache_;
+    std::vector<std::size_t> tags_;
+    std::vector<uint64_t> lastUse_;
+    uint64_t tick_;
+};
@@ -7,6 +7,11 @@
 #include <vector>
 #include <ranges>
 
+#include "dispatch.h"
+#include "perfect_hash.h"
+#include "reduce.h"
+#include "sum.h"
+
 using namespace std;
 
 
@@ -57,8 +62,7 @@ void FizzBuzz() {
     cout << endl;
 }
 
-template <const char* C>
-struct Str {};
+// Str<const char*> in perfect_hash.h
 
 constexpr char CIAO[] = "ciao";
 constexpr char HELLO[] = "hello";
@@ -73,13 +77,16 @@ void P(S) requires Hello<S>
 template <Hello H>
 void Q(H) {}
 
+// runtime lookup of compile time keys: one hash, one compare
+constexpr auto GREETINGS = MakePerfectHash<Str<CIAO>, Str<HELLO>>();
+static_assert(GREETINGS.Find("hello") == 1 && GREETINGS.Find("hi") == -1);
+
 template <typename F1, typename F2>
 concept divisible = requires(F1 f1, F2 f2) { f1 / f2 ;};
 
 static_assert(divisible<int, float>);
 
-template <typename T>
-concept number = is_integral<T>::value || is_floating_point<T>::value;
+// concept number in sum.h
 
 //template <typename...ArgsT>
 //concept integers = (... && is_integral<ArgsT>::value)
@@ -91,18 +98,28 @@ struct Head {
 };
 
 
+// balanced pairwise tree instead of a left fold: independent additions and
+// O(log N) rounding error for floating point
 template <typename...NumbersT>
 constexpr typename Head<NumbersT...>::Type
 Sum(NumbersT...nums) requires (... && number<NumbersT>) {
     using T = typename Head<NumbersT...>::Type;
-    return (... + T(nums));
+    return ReducePack<T>(plus<>(), nums...);
 }
 
+static_assert(Sum(1, 2, 3, 4, 5, 6, 7, 8, 9) == 45);
+
 int main(int argc, char const *argv[]) {
     cout << Sum(1.0, 2, 4.f) << endl;
+    // ranges: vector goes to the SIMD kernels, list is iterated
+    cout << Sum(vector<float>{1.f, 2.f, 4.f}) << ' '
+         << Sum(list<int>{1, 2, 4}) << endl;
     S<int> s;
     //s.P(); //compilation error
     FizzBuzz<1,2,3,4,5,6,7,8,9,10,11,12,13,14,15>();
+    // same with runtime values, through a table of FB<I> instantiations
+    for(int i = 1; i != 16; ++i) Dispatch<1, 16>(i, []<int I>() { FB<I>(); });
+    cout << endl;
     for(int i = 2; i > 0; i--) cout << i << endl;
     vector<int> vi = {1,2,3,4};
     list<int> li = {1,2,3,4};
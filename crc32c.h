@@ -0,0 +1,225 @@
+// Author: Ugo Varetto
+// CRC32C (Castagnoli, as used by iSCSI, ext4, RocksDB) of byte buffers and
+// copy fused with the checksum: CopyChecksummed reads each byte once, copying
+// it and feeding it to the CRC, instead of a memcpy followed by a second pass
+// over the destination.
+// Kernels:
+// - TABLE: slicing by 8, eight 256 entry tables, 8 bytes per step
+// - SSE42: crc32 instruction on three independent streams to hide its 3
+//          cycle latency, the three CRCs are combined by shifting the first
+//          ones over the length of the following streams (multiplication by
+//          x^(8 * length) modulo the polynomial, table driven)
+// Checksums are incremental: Crc32c(b, nb, Crc32c(a, na)) is the CRC of a
+// followed by b.
+//   uint32_t crc = 0;
+//   for (auto& chunk : payload) crc = CopyBufferChecksummed(chunk, io, crc);
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "raw_buffer.h"
+
+#if defined(__x86_64__)
+#define CRC32C_X86
+#include <immintrin.h>
+#endif
+
+enum class Crc32cKernel { TABLE, SSE42 };
+
+namespace crc32c_detail {
+// reflected Castagnoli polynomial
+constexpr uint32_t POLY = 0x82F63B78;
+// stream lengths of the three way SSE42 kernel
+constexpr std::size_t LONG = 8192;
+constexpr std::size_t SHORT = 256;
+
+inline uint64_t Load64(const char* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// a * b modulo POLY, bit reflected: x^0 is the top bit
+inline uint32_t MultModP(uint32_t a, uint32_t b) {
+    uint32_t p = 0;
+    for (uint32_t m = uint32_t(1) << 31; m; m >>= 1) {
+        if (a & m) p ^= b;
+        b = b & 1 ? (b >> 1) ^ POLY : b >> 1;
+    }
+    return p;
+}
+
+// x^(8 * bytes) modulo POLY
+inline uint32_t XPow8(std::size_t bytes) {
+    uint32_t r = uint32_t(1) << 31;  // x^0
+    uint32_t sq = uint32_t(1) << 23;  // x^8
+    for (; bytes; bytes >>= 1, sq = MultModP(sq, sq)) {
+        if (bytes & 1) r = MultModP(r, sq);
+    }
+    return r;
+}
+
+struct Tables {
+    // slicing by 8
+    uint32_t slice[8][256];
+    // register after LONG and SHORT zero bytes, one table per register byte
+    uint32_t shiftLong[4][256];
+    uint32_t shiftShort[4][256];
+    Tables() {
+        for (uint32_t i = 0; i != 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k != 8; ++k) c = c & 1 ? (c >> 1) ^ POLY : c >> 1;
+            slice[0][i] = c;
+        }
+        for (uint32_t i = 0; i != 256; ++i) {
+            for (int t = 1; t != 8; ++t) {
+                const uint32_t c = slice[t - 1][i];
+                slice[t][i] = (c >> 8) ^ slice[0][c & 0xFF];
+            }
+        }
+        const uint32_t xl = XPow8(LONG);
+        const uint32_t xs = XPow8(SHORT);
+        for (uint32_t i = 0; i != 256; ++i) {
+            for (int b = 0; b != 4; ++b) {
+                shiftLong[b][i] = MultModP(xl, i << (8 * b));
+                shiftShort[b][i] = MultModP(xs, i << (8 * b));
+            }
+        }
+    }
+};
+
+inline const Tables& GetTables() {
+    static const Tables tables;
+    return tables;
+}
+
+inline uint32_t Shift(const uint32_t (&t)[4][256], uint32_t crc) {
+    return t[0][crc & 0xFF] ^ t[1][(crc >> 8) & 0xFF] ^
+           t[2][(crc >> 16) & 0xFF] ^ t[3][crc >> 24];
+}
+
+// Kernels update the raw CRC register (no pre and post inversion) with
+// [p, p + n), copying the bytes to d if COPY
+template <bool COPY>
+uint32_t UpdateTable(uint32_t crc, const char* p, std::size_t n, char* d) {
+    const auto& t = GetTables().slice;
+    for (; n >= 8; n -= 8, p += 8, d += COPY ? 8 : 0) {
+        const uint64_t v = Load64(p);
+        if constexpr (COPY) std::memcpy(d, &v, 8);
+        const uint64_t x = v ^ crc;
+        crc = t[7][x & 0xFF] ^ t[6][(x >> 8) & 0xFF] ^
+              t[5][(x >> 16) & 0xFF] ^ t[4][(x >> 24) & 0xFF] ^
+              t[3][(x >> 32) & 0xFF] ^ t[2][(x >> 40) & 0xFF] ^
+              t[1][(x >> 48) & 0xFF] ^ t[0][x >> 56];
+    }
+    for (; n; --n, ++p, d += COPY ? 1 : 0) {
+        if constexpr (COPY) *d = *p;
+        crc = (crc >> 8) ^ t[0][(crc ^ uint8_t(*p)) & 0xFF];
+    }
+    return crc;
+}
+
+#ifdef CRC32C_X86
+// three streams of L bytes each
+template <bool COPY, std::size_t L>
+__attribute__((target("sse4.2"))) inline uint32_t Update3(
+    uint32_t crc, const char* p, char* d, const uint32_t (&shift)[4][256]) {
+    uint64_t c0 = crc, c1 = 0, c2 = 0;
+    for (std::size_t i = 0; i != L; i += 8) {
+        const uint64_t v0 = Load64(p + i);
+        const uint64_t v1 = Load64(p + L + i);
+        const uint64_t v2 = Load64(p + 2 * L + i);
+        if constexpr (COPY) {
+            std::memcpy(d + i, &v0, 8);
+            std::memcpy(d + L + i, &v1, 8);
+            std::memcpy(d + 2 * L + i, &v2, 8);
+        }
+        c0 = _mm_crc32_u64(c0, v0);
+        c1 = _mm_crc32_u64(c1, v1);
+        c2 = _mm_crc32_u64(c2, v2);
+    }
+    return Shift(shift, Shift(shift, uint32_t(c0)) ^ uint32_t(c1)) ^
+           uint32_t(c2);
+}
+
+template <bool COPY>
+__attribute__((target("sse4.2"))) uint32_t UpdateSSE42(uint32_t crc,
+                                                       const char* p,
+                                                       std::size_t n,
+                                                       char* d) {
+    const Tables& t = GetTables();
+    for (; n >= 3 * LONG; n -= 3 * LONG, p += 3 * LONG) {
+        crc = Update3<COPY, LONG>(crc, p, d, t.shiftLong);
+        if constexpr (COPY) d += 3 * LONG;
+    }
+    for (; n >= 3 * SHORT; n -= 3 * SHORT, p += 3 * SHORT) {
+        crc = Update3<COPY, SHORT>(crc, p, d, t.shiftShort);
+        if constexpr (COPY) d += 3 * SHORT;
+    }
+    uint64_t c = crc;
+    for (; n >= 8; n -= 8, p += 8, d += COPY ? 8 : 0) {
+        const uint64_t v = Load64(p);
+        if constexpr (COPY) std::memcpy(d, &v, 8);
+        c = _mm_crc32_u64(c, v);
+    }
+    crc = uint32_t(c);
+    for (; n; --n, ++p, d += COPY ? 1 : 0) {
+        if constexpr (COPY) *d = *p;
+        crc = _mm_crc32_u8(crc, uint8_t(*p));
+    }
+    return crc;
+}
+#endif
+
+template <bool COPY>
+uint32_t Update(uint32_t crc, const char* p, std::size_t n, char* d,
+                Crc32cKernel k) {
+#ifdef CRC32C_X86
+    if (k == Crc32cKernel::SSE42) return ~UpdateSSE42<COPY>(~crc, p, n, d);
+#endif
+    return ~UpdateTable<COPY>(~crc, p, n, d);
+}
+}  // namespace crc32c_detail
+
+inline bool Supported(Crc32cKernel k) {
+#ifdef CRC32C_X86
+    return k == Crc32cKernel::TABLE || __builtin_cpu_supports("sse4.2");
+#else
+    return k == Crc32cKernel::TABLE;
+#endif
+}
+
+inline Crc32cKernel BestCrc32cKernel() {
+    static const Crc32cKernel best = Supported(Crc32cKernel::SSE42)
+                                         ? Crc32cKernel::SSE42
+                                         : Crc32cKernel::TABLE;
+    return best;
+}
+
+// CRC32C of [data, data + size) continuing from crc, 0 for a new checksum
+inline uint32_t Crc32c(const void* data, std::size_t size, uint32_t crc = 0,
+                       Crc32cKernel k = BestCrc32cKernel()) {
+    return crc32c_detail::Update<false>(
+        crc, static_cast<const char*>(data), size, nullptr, k);
+}
+
+// copies size bytes from src to dest (not overlapping), returns the CRC32C
+// of the copied bytes continuing from crc
+inline uint32_t CopyChecksummed(void* dest, const void* src, std::size_t size,
+                                uint32_t crc = 0,
+                                Crc32cKernel k = BestCrc32cKernel()) {
+    return crc32c_detail::Update<true>(crc, static_cast<const char*>(src),
+                                       size, static_cast<char*>(dest), k);
+}
+
+// CopyBuffer and CRC32C of the copied bytes in a single pass
+inline uint32_t CopyBufferChecksummed(const RawBuffer& src, RawBuffer& dest,
+                                      uint32_t crc = 0,
+                                      Crc32cKernel k = BestCrc32cKernel()) {
+    const std::size_t sz =
+        src.Size() <= dest.Size() ? src.Size() : dest.Size();
+    return CopyChecksummed(dest.Data(), src.Data(), sz, crc, k);
+}
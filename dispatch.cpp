@@ -0,0 +1,146 @@
+//
+// Runtime to template dispatch cost: Dispatch<0, N> switch, function
+// pointer table and binary tree vs a hand written switch, with predictable
+// and random indices
+// Usage: dispatch [num calls, default 2^24]
+// Author: Ugo Varetto
+//
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "dispatch.h"
+
+using namespace std;
+
+using Clock = chrono::high_resolution_clock;
+template <typename TimeDiffNsT>
+constexpr double NsToSec(const TimeDiffNsT& diff) {
+    return double(chrono::duration_cast<chrono::nanoseconds>(diff).count()) /
+           1E9;
+}
+
+//------------------------------------------------------------------------------
+// Specialized code per index: a different multiply-add for each I
+struct Kernel {
+    uint64_t x = 1;
+    template <int I>
+    uint64_t operator()() {
+        x = x * (2 * I + 1) + I;
+        return x;
+    }
+};
+
+struct Square {
+    template <int I>
+    constexpr int operator()() const {
+        return I * I;
+    }
+};
+
+uint64_t HandWrittenSwitch(int i, Kernel& k) {
+    switch (i) {
+        case 0:
+            return k.operator()<0>();
+        case 1:
+            return k.operator()<1>();
+        case 2:
+            return k.operator()<2>();
+        case 3:
+            return k.operator()<3>();
+        case 4:
+            return k.operator()<4>();
+        case 5:
+            return k.operator()<5>();
+        case 6:
+            return k.operator()<6>();
+        case 7:
+            return k.operator()<7>();
+        case 8:
+            return k.operator()<8>();
+        case 9:
+            return k.operator()<9>();
+        case 10:
+            return k.operator()<10>();
+        case 11:
+            return k.operator()<11>();
+        case 12:
+            return k.operator()<12>();
+        case 13:
+            return k.operator()<13>();
+        case 14:
+            return k.operator()<14>();
+        case 15:
+            return k.operator()<15>();
+    }
+    return 0;
+}
+
+template <typename F>
+double Time(const vector<int>& indices, uint64_t& check, F f) {
+    Kernel k;
+    const auto start = Clock::now();
+    for (int i : indices) f(i, k);
+    const double t = NsToSec(Clock::now() - start);
+    check = k.x;
+    return 1E9 * t / indices.size();
+}
+
+template <int N>
+bool Bench(const string& label, const vector<int>& indices) {
+    uint64_t c[4] = {};
+    const double tswitch = Time(indices, c[0], [](int i, Kernel& k) {
+        return Dispatch<0, N, DispatchMode::SWITCH>(i, k);
+    });
+    const double ttable = Time(indices, c[1], [](int i, Kernel& k) {
+        return Dispatch<0, N, DispatchMode::TABLE>(i, k);
+    });
+    const double ttree = Time(indices, c[2], [](int i, Kernel& k) {
+        return Dispatch<0, N, DispatchMode::TREE>(i, k);
+    });
+    cout << setw(4) << N << "  " << label << setw(10) << tswitch << setw(10)
+         << ttable << setw(10) << ttree;
+    if constexpr (N == 16) {
+        cout << setw(10) << Time(indices, c[3], HandWrittenSwitch);
+    } else {
+        c[3] = c[0];
+    }
+    cout << endl;
+    return c[0] == c[1] && c[1] == c[2] && c[2] == c[3];
+}
+
+template <int N>
+bool BenchInputs(size_t calls) {
+    mt19937 gen(N);
+    vector<int> indices(calls);
+    // runs of 256 equal indices
+    for (size_t i = 0; i != calls; ++i) indices[i] = int(i / 256 % N);
+    bool ok = Bench<N>("runs  ", indices);
+    for (auto& i : indices) i = int(gen() % N);
+    return Bench<N>("random", indices) && ok;
+}
+
+//------------------------------------------------------------------------------
+int main(int argc, char const* argv[]) {
+    const size_t calls = argc > 1 ? stoull(argv[1]) : size_t(1) << 24;
+    for (int i = 3; i != 9; ++i) {
+        if (Dispatch<3, 9>(i, Square()) != i * i ||
+            Dispatch<3, 9, DispatchMode::SWITCH>(i, Square()) != i * i ||
+            Dispatch<3, 9, DispatchMode::TREE>(i, Square()) != i * i) {
+            cerr << "ERROR: wrong dispatch" << endl;
+            return 1;
+        }
+    }
+    cout << setprecision(3) << "ns/call" << endl
+         << "   N  input       switch     table      tree  hand switch"
+         << endl;
+    bool ok = BenchInputs<16>(calls);
+    ok = BenchInputs<128>(calls) && ok;
+    cout << (ok ? "results match" : "ERROR: results differ") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+// Author: Ugo Varetto
+// Runtime to compile time dispatch: Dispatch<First, Last>(i, f) calls
+// f.template operator()<I>() with I == i, i in [First, Last), generating the
+// code that maps the value to the instantiation:
+// - SWITCH: chain of comparisons, compilers turn it into a jump table
+// - TABLE:  constexpr array of function pointers indexed by i - First
+// - TREE:   binary search on i, log2(Last - First) predictable compares
+// With C++20 a generic lambda works as f:
+//   Dispatch<0, 16>(i, []<int I>() { return Kernel<I>(); });
+// Returns the result of the call, non void results must be default
+// constructible; i out of range is a precondition violation.
+
+#pragma once
+
+#include <cassert>
+#include <type_traits>
+
+#include "index_sequence.h"
+
+enum class DispatchMode { SWITCH, TABLE, TREE };
+
+namespace dispatch_detail {
+template <int I, typename F>
+decltype(auto) Call(F& f) {
+    return f.template operator()<I>();
+}
+
+template <typename R, typename F, int... I>
+R Switch(int i, F& f, Idx<I...>) {
+    if constexpr (std::is_void<R>::value) {
+        (void)(... || (i == I && (Call<I>(f), true)));
+    } else {
+        R r{};
+        (void)(... || (i == I && (r = Call<I>(f), true)));
+        return r;
+    }
+}
+
+template <typename R, int FIRST, typename F, int... I>
+R Table(int i, F& f, Idx<I...>) {
+    using Fn = R (*)(F&);
+    static constexpr Fn TABLE[] = {&Call<I, F>...};
+    return TABLE[i - FIRST](f);
+}
+
+// [FIRST, LAST)
+template <typename R, int FIRST, int LAST, typename F>
+R Tree(int i, F& f) {
+    if constexpr (LAST - FIRST == 1) {
+        return Call<FIRST>(f);
+    } else {
+        constexpr int MID = FIRST + (LAST - FIRST) / 2;
+        if (i < MID) return Tree<R, FIRST, MID>(i, f);
+        return Tree<R, MID, LAST>(i, f);
+    }
+}
+}  // namespace dispatch_detail
+
+//------------------------------------------------------------------------------
+template <int First, int Last, DispatchMode Mode = DispatchMode::TABLE,
+          typename F>
+decltype(auto) Dispatch(int i, F&& f) {
+    static_assert(Last > First, "empty range");
+    using Fn = std::remove_reference_t<F>;
+    using R = decltype(dispatch_detail::Call<First>(f));
+    using Index = typename MakeIndexSequence<Last - First, First>::Type;
+    assert(i >= First && i < Last);
+    if constexpr (Mode == DispatchMode::SWITCH) {
+        return dispatch_detail::Switch<R, Fn>(i, f, Index());
+    } else if constexpr (Mode == DispatchMode::TABLE) {
+        return dispatch_detail::Table<R, First, Fn>(i, f, Index());
+    } else {
+        return dispatch_detail::Tree<R, First, Last, Fn>(i, f);
+    }
+}
@@ -0,0 +1,103 @@
+//
+// Lower bound search in sorted 32 bit keys: std::lower_bound vs Eytzinger
+// layout with branch free descent and prefetch, one key at a time and
+// batched, from L1 sized arrays up to the maximum size; arrays are stored
+// in RawBuffers on huge pages.
+// Memory: 2 x max size (sorted keys + index).
+// Usage: eytzinger [max array size in MiB, default 1024, 4096 for 4 GiB]
+//                  [num lookups, default 2^22]
+// Author: Ugo Varetto
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "eytzinger.h"
+#include "raw_buffer.h"
+
+using namespace std;
+
+using Clock = chrono::high_resolution_clock;
+template <typename TimeDiffNsT>
+constexpr double NsToSec(const TimeDiffNsT& diff) {
+    return double(chrono::duration_cast<chrono::nanoseconds>(diff).count()) /
+           1E9;
+}
+
+//------------------------------------------------------------------------------
+template <typename F>
+double Time(size_t lookups, uint64_t& check, F f) {
+    const auto start = Clock::now();
+    check = f();
+    return 1E9 * NsToSec(Clock::now() - start) / lookups;
+}
+
+// keys 1, 3, 5...: half of the random queries miss
+bool Bench(size_t n, const vector<uint32_t>& queries) {
+    RawBuffer buffer = HugePageBuffer(n * sizeof(uint32_t));
+    if (!buffer.Size()) {
+        cerr << "cannot allocate " << n * sizeof(uint32_t) << " bytes" << endl;
+        return false;
+    }
+    uint32_t* sorted = reinterpret_cast<uint32_t*>(buffer.Data());
+    for (size_t i = 0; i != n; ++i) sorted[i] = uint32_t(2 * i + 1);
+    const EytzingerIndex<uint32_t> index(sorted, sorted + n);
+    if (index.Size() != n) {
+        cerr << "cannot allocate index" << endl;
+        return false;
+    }
+    // queries in [0, 2n + 2)
+    vector<uint32_t> q(queries.size());
+    for (size_t i = 0; i != q.size(); ++i) {
+        q[i] = uint32_t(queries[i] % (2 * n + 2));
+    }
+    vector<size_t> slots(q.size());
+    uint64_t c[3];
+    // sum of found keys, UINT32_MAX when none
+    const double tstd = Time(q.size(), c[0], [&] {
+        uint64_t s = 0;
+        for (uint32_t x : q) {
+            const uint32_t* i = lower_bound(sorted, sorted + n, x);
+            s += i == sorted + n ? UINT32_MAX : *i;
+        }
+        return s;
+    });
+    const double tey = Time(q.size(), c[1], [&] {
+        uint64_t s = 0;
+        for (uint32_t x : q) s += index[index.LowerBound(x)];
+        return s;
+    });
+    const double tbatch = Time(q.size(), c[2], [&] {
+        index.LowerBound(q.data(), slots.data(), q.size());
+        uint64_t s = 0;
+        for (size_t k : slots) s += index[k];
+        return s;
+    });
+    cout << setw(10) << n * sizeof(uint32_t) / 1024 << setw(12) << tstd << setw(12) << tey
+         << setw(12) << tbatch << endl;
+    return c[0] == c[1] && c[1] == c[2];
+}
+
+//------------------------------------------------------------------------------
+int main(int argc, char const* argv[]) {
+    const size_t maxBytes = (argc > 1 ? stoull(argv[1]) : 1024) << 20;
+    const size_t lookups = argc > 2 ? stoull(argv[2]) : size_t(1) << 22;
+    mt19937 gen(1);
+    vector<uint32_t> queries(lookups);
+    for (auto& q : queries) q = gen();
+    cout << setprecision(3) << "ns/lookup" << endl
+         << "  size KiB  lower_bound  eytzinger     batched" << endl;
+    bool ok = true;
+    // 4 KiB (L1) to max
+    for (size_t n = 1024; n * sizeof(uint32_t) <= maxBytes; n *= 4) {
+        ok = Bench(n, queries) && ok;
+    }
+    cout << (ok ? "results match" : "ERROR: results differ") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+// Author: Ugo Varetto
+// Static search index over sorted keys stored in Eytzinger (BFS) order:
+// node k has children 2k and 2k + 1, the first levels share cache lines and
+// the 16 (4 byte keys) descendants four levels down are contiguous, so they
+// are prefetched with a single instruction while the current level is
+// compared.
+// The search has no data dependent branches: a fixed number of levels is
+// visited, the comparison result is appended to the node index and the
+// lower bound is recovered from the trailing ones of the final index.
+// Slots are 1 based, 0 means no key >= x:
+//   EytzingerIndex<uint32_t> index(sorted.begin(), sorted.end());
+//   const size_t k = index.LowerBound(x);
+//   if (k) use(index[k]);
+// LowerBound(keys, slots, n) interleaves Batch searches to overlap their
+// cache misses.
+// Keys live in a RawBuffer, on 2 MiB aligned huge pages above 2 MiB.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include "raw_buffer.h"
+
+template <typename T>
+class EytzingerIndex {
+    static_assert(std::is_arithmetic<T>::value, "arithmetic keys only");
+
+   public:
+    // keys in the same cache line four (4 byte keys) levels down
+    static constexpr std::size_t CACHE_LINE = 64;
+    static constexpr std::size_t STRIDE = CACHE_LINE / sizeof(T);
+
+    template <typename It>
+    EytzingerIndex(It first, It last)
+        : buffer_(Allocate(std::size_t(std::distance(first, last)))),
+          keys_(reinterpret_cast<T*>(buffer_.Data())),
+          size_(std::size_t(std::distance(first, last))),
+          levels_(0) {
+        if (!buffer_.Size()) {
+            size_ = 0;
+            return;
+        }
+        // slot 0: returned when x > all keys, never less than x
+        keys_[0] = std::numeric_limits<T>::max();
+        Build(first, 1);
+        // complete levels: nodes [1, 2^levels_) all present
+        while ((std::size_t(2) << levels_) - 1 <= size_) ++levels_;
+    }
+    // keys_ points into buffer_: not copyable, moves re-derive it
+    EytzingerIndex(const EytzingerIndex&) = delete;
+    EytzingerIndex& operator=(const EytzingerIndex&) = delete;
+    EytzingerIndex(EytzingerIndex&& other)
+        : buffer_(std::move(other.buffer_)),
+          keys_(reinterpret_cast<T*>(buffer_.Data())),
+          size_(other.size_),
+          levels_(other.levels_) {
+        other.keys_ = nullptr;
+        other.size_ = 0;
+        other.levels_ = 0;
+    }
+    std::size_t Size() const { return size_; }
+    const T& operator[](std::size_t slot) const { return keys_[slot]; }
+
+    // slot of first key >= x, 0 if none
+    std::size_t LowerBound(T x) const {
+        std::size_t k = 1;
+        for (int l = 0; l != levels_; ++l) {
+            __builtin_prefetch(keys_ + k * STRIDE);
+            k = 2 * k + (keys_[k] < x);
+        }
+        return Last(k, x);
+    }
+
+    // slots[i] = LowerBound(keys[i])
+    template <int Batch = 16>
+    void LowerBound(const T* keys, std::size_t* slots, std::size_t n) const {
+        std::size_t i = 0;
+        for (; i + Batch <= n; i += Batch) {
+            std::size_t k[Batch];
+            for (int b = 0; b != Batch; ++b) k[b] = 1;
+            for (int l = 0; l != levels_; ++l) {
+                for (int b = 0; b != Batch; ++b) {
+                    __builtin_prefetch(keys_ + k[b] * STRIDE);
+                    k[b] = 2 * k[b] + (keys_[k[b]] < keys[i + b]);
+                }
+            }
+            for (int b = 0; b != Batch; ++b) {
+                slots[i + b] = Last(k[b], keys[i + b]);
+            }
+        }
+        for (; i != n; ++i) slots[i] = LowerBound(keys[i]);
+    }
+
+   private:
+    static RawBuffer Allocate(std::size_t n) {
+        // aligned_alloc wants a multiple of the alignment
+        const std::size_t bytes =
+            ((n + 1) * sizeof(T) + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+        return bytes < (std::size_t(1) << 21) ? RawBuffer(bytes, CACHE_LINE)
+                                              : HugePageBuffer(bytes);
+    }
+    // in order traversal of the implicit tree assigns sorted keys
+    template <typename It>
+    void Build(It& i, std::size_t k) {
+        if (k > size_) return;
+        Build(i, 2 * k);
+        keys_[k] = *i++;
+        Build(i, 2 * k + 1);
+    }
+    // descend into the incomplete last level if k exists, then drop the
+    // right turns taken after the last left turn: that node is the answer
+    std::size_t Last(std::size_t k, T x) const {
+        const bool inside = k <= size_;
+        const std::size_t next = 2 * k + (keys_[inside ? k : 0] < x);
+        k = inside ? next : k;
+        return k >> (__builtin_ctzll(~k) + 1);
+    }
+
+   private:
+    RawBuffer buffer_;
+    T* keys_;
+    std::size_t size_;
+    int levels_;
+};
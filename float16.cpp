@@ -0,0 +1,611 @@
+//
+// Batch float32 <--> float16 (IEEE-754 binary16) and bfloat16 conversion:
+// AVX2/F16C and SSE2 kernels with portable scalar fallback, all of them
+// rounding to nearest even and preserving NaN payloads, infinities and
+// subnormals; results are bit-identical across kernels.
+// Usage: float16 [accuracy] [bench [num values]]
+// Author: Ugo Varetto
+//
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define FLOAT16_X86
+#include <immintrin.h>
+#endif
+
+#include "float_bits.h"
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+// 16 bit layouts, tag types only used to select the traits
+// float16:  |15  |14.....10|9......0|   bfloat16: |15  |14......7|6......0|
+//           |sign|exp+15   |mantissa|             |sign|exp+127  |mantissa|
+struct Float16 {};
+struct BFloat16 {};
+
+template <>
+struct FloatTraits<Float16> {
+    enum : int32_t { SIGN_BIT = 15, MANTISSA_LENGTH = 10, EXP_LENGTH = 5 };
+    // after right shift
+    enum : uint16_t {
+        BIT_MASK = 0x8000,
+        MANTISSA_MASK = 0x03FF,
+        EXP_MASK = 0x001F
+    };
+    enum : int32_t { EXP_OFFSET = 15 };
+    enum : int32_t { MIN_EXP = 14 };
+    enum : uint16_t {
+        POSITIVE_INFINITE = 0x7C00,
+        NEGATIVE_INFINITE = 0xFC00,
+        QUIET_NAN = 0x7E00
+    };
+    using IntType = int16_t;
+    using UIntType = uint16_t;
+};
+
+template <>
+struct FloatTraits<BFloat16> {
+    enum : int32_t { SIGN_BIT = 15, MANTISSA_LENGTH = 7, EXP_LENGTH = 8 };
+    // after right shift
+    enum : uint16_t {
+        BIT_MASK = 0x8000,
+        MANTISSA_MASK = 0x007F,
+        EXP_MASK = 0x00FF
+    };
+    enum : int32_t { EXP_OFFSET = 127 };
+    enum : int32_t { MIN_EXP = 126 };
+    enum : uint16_t {
+        POSITIVE_INFINITE = 0x7F80,
+        NEGATIVE_INFINITE = 0xFF80,
+        QUIET_NAN = 0x7FC0
+    };
+    using IntType = int16_t;
+    using UIntType = uint16_t;
+};
+
+using F32 = FloatTraits<float>;
+using F16 = FloatTraits<Float16>;
+using BF16 = FloatTraits<BFloat16>;
+
+// constants shared by scalar and SIMD kernels
+enum : uint32_t {
+    // mantissa bits dropped when narrowing float to float16 and bfloat16
+    F16_SHIFT = F32::MANTISSA_LENGTH - F16::MANTISSA_LENGTH,
+    BF16_SHIFT = F32::MANTISSA_LENGTH - BF16::MANTISSA_LENGTH,
+    // rebias float exponent to float16 exponent
+    F16_REBIAS = uint32_t(F32::EXP_OFFSET - F16::EXP_OFFSET)
+                 << F32::MANTISSA_LENGTH,
+    // 2^-14 smallest normalized float16, 65520 first value rounding to inf
+    F16_MIN_NORMAL = uint32_t(F32::EXP_OFFSET - F16::MIN_EXP)
+                     << F32::MANTISSA_LENGTH,
+    F16_OVERFLOW = 0x477FF000,
+    // adding 0.5f aligns a float16 subnormal to the float mantissa lsb
+    F16_DENORM_MAGIC = 0x3F000000
+};
+
+//------------------------------------------------------------------------------
+// Scalar kernels
+// float -> float16: round to nearest even, NaN keeps the upper payload bits
+// and is quieted (same as F16C)
+uint16_t FloatToHalf(const float f) {
+    const uint32_t u = FloatToBits(f);
+    const uint32_t sign = (u >> 16) & F16::BIT_MASK;
+    const uint32_t a = u & ~uint32_t(F32::BIT_MASK);
+    if (a > F32::POSITIVE_INFINITE)
+        return sign | F16::QUIET_NAN | ((a >> F16_SHIFT) & F16::MANTISSA_MASK);
+    if (a >= F16_OVERFLOW) return sign | F16::POSITIVE_INFINITE;
+    uint32_t r = 0;
+    if (a >= F16_MIN_NORMAL) {
+        r = (a - F16_REBIAS) >> F16_SHIFT;
+        const uint32_t rem = a & ((1 << F16_SHIFT) - 1);
+        const uint32_t half = 1 << (F16_SHIFT - 1);
+        r += rem > half || (rem == half && (r & 1));
+    } else {
+        // value in units of 2^-24 is mantissa x 2^(exponent - 126)
+        const uint32_t e = a >> F32::MANTISSA_LENGTH;
+        const uint32_t shift = F32::MIN_EXP - e;
+        if (shift <= F32::MANTISSA_LENGTH + 1) {
+            const uint32_t m = (a & F32::MANTISSA_MASK) |
+                               (uint32_t(1) << F32::MANTISSA_LENGTH);
+            r = m >> shift;
+            const uint32_t rem = m & ((uint32_t(1) << shift) - 1);
+            const uint32_t half = uint32_t(1) << (shift - 1);
+            r += rem > half || (rem == half && (r & 1));
+        }
+    }
+    return uint16_t(sign | r);
+}
+
+// float16 -> float: exact, signaling NaNs are quieted (same as F16C)
+float HalfToFloat(const uint16_t h) {
+    const uint32_t sign = uint32_t(h & F16::BIT_MASK) << 16;
+    const uint32_t e = (h >> F16::MANTISSA_LENGTH) & F16::EXP_MASK;
+    const uint32_t m = h & F16::MANTISSA_MASK;
+    if (e == F16::EXP_MASK) {
+        const uint32_t nan = m ? (F32::QUIET_NAN | (m << F16_SHIFT)) : 0;
+        return BitsToFloat<float>(sign | F32::POSITIVE_INFINITE | nan);
+    }
+    if (e == 0) {
+        const float v = float(m) * 0x1p-24f;
+        return sign ? -v : v;
+    }
+    return BitsToFloat<float>(sign |
+                              ((e << F32::MANTISSA_LENGTH) + F16_REBIAS) |
+                              (m << F16_SHIFT));
+}
+
+// float -> bfloat16: round to nearest even, NaN quieted
+uint16_t FloatToBFloat16(const float f) {
+    const uint32_t u = FloatToBits(f);
+    if ((u & ~uint32_t(F32::BIT_MASK)) > F32::POSITIVE_INFINITE)
+        return uint16_t((u >> BF16_SHIFT) | (F32::QUIET_NAN >> BF16_SHIFT));
+    return uint16_t((u + 0x7FFF + ((u >> 16) & 1)) >> 16);
+}
+
+float BFloat16ToFloat(const uint16_t b) {
+    return BitsToFloat<float>(uint32_t(b) << 16);
+}
+
+void FloatToHalfScalar(const float* in, uint16_t* out, size_t n) {
+    for (size_t i = 0; i != n; ++i) out[i] = FloatToHalf(in[i]);
+}
+void HalfToFloatScalar(const uint16_t* in, float* out, size_t n) {
+    for (size_t i = 0; i != n; ++i) out[i] = HalfToFloat(in[i]);
+}
+void FloatToBFloat16Scalar(const float* in, uint16_t* out, size_t n) {
+    for (size_t i = 0; i != n; ++i) out[i] = FloatToBFloat16(in[i]);
+}
+void BFloat16ToFloatScalar(const uint16_t* in, float* out, size_t n) {
+    for (size_t i = 0; i != n; ++i) out[i] = BFloat16ToFloat(in[i]);
+}
+
+#ifdef FLOAT16_X86
+//------------------------------------------------------------------------------
+// SSE2 kernels, 4 values per step, integer version of the scalar code:
+// subnormals are rounded by the FPU adding F16_DENORM_MAGIC, normals by
+// adding 0xFFF + lsb of the result
+namespace {
+inline __m128i Select(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+// 32 -> 16 bit truncation with signed saturating pack
+inline __m128i Pack32To16(__m128i a, __m128i b) {
+    a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+    b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+    return _mm_packs_epi32(a, b);
+}
+
+inline __m128i FloatToHalfSSE(__m128 f) {
+    const __m128i u = _mm_castps_si128(f);
+    const __m128i sign = _mm_and_si128(u, _mm_set1_epi32(F32::BIT_MASK));
+    const __m128i a = _mm_xor_si128(u, sign);
+    // normalized
+    const __m128i odd =
+        _mm_and_si128(_mm_srli_epi32(a, F16_SHIFT), _mm_set1_epi32(1));
+    __m128i n = _mm_sub_epi32(a, _mm_set1_epi32(F16_REBIAS - 0xFFF));
+    n = _mm_srli_epi32(_mm_add_epi32(n, odd), F16_SHIFT);
+    // subnormal
+    const __m128 magic = _mm_castsi128_ps(_mm_set1_epi32(F16_DENORM_MAGIC));
+    const __m128i d =
+        _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(a), magic)),
+                      _mm_set1_epi32(F16_DENORM_MAGIC));
+    // infinite and NaN
+    const __m128i nan = _mm_cmpgt_epi32(a, _mm_set1_epi32(F32::POSITIVE_INFINITE));
+    const __m128i payload = _mm_or_si128(
+        _mm_set1_epi32(F16::QUIET_NAN),
+        _mm_and_si128(_mm_srli_epi32(a, F16_SHIFT),
+                      _mm_set1_epi32(F16::MANTISSA_MASK)));
+    const __m128i big = Select(nan, payload, _mm_set1_epi32(F16::POSITIVE_INFINITE));
+    __m128i r = Select(_mm_cmplt_epi32(a, _mm_set1_epi32(F16_MIN_NORMAL)), d, n);
+    r = Select(_mm_cmpgt_epi32(a, _mm_set1_epi32(F16_OVERFLOW - 1)), big, r);
+    return _mm_or_si128(r, _mm_srli_epi32(sign, 16));
+}
+
+inline __m128 HalfToFloatSSE(__m128i h) {
+    const __m128i EXP = _mm_set1_epi32(F16::EXP_MASK << 23);
+    const __m128i MAGIC = _mm_set1_epi32(F16_MIN_NORMAL);
+    __m128i o = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x7FFF)),
+                               F16_SHIFT);
+    const __m128i e = _mm_and_si128(o, EXP);
+    o = _mm_add_epi32(o, _mm_set1_epi32(F16_REBIAS));
+    // infinite and NaN: move exponent to 255, quiet NaNs
+    const __m128i infnan = _mm_cmpeq_epi32(e, EXP);
+    const __m128i nan = _mm_andnot_si128(
+        _mm_cmpeq_epi32(_mm_and_si128(h, _mm_set1_epi32(F16::MANTISSA_MASK)),
+                        _mm_setzero_si128()),
+        infnan);
+    o = _mm_add_epi32(o, _mm_and_si128(infnan, _mm_set1_epi32(F16_REBIAS)));
+    o = _mm_or_si128(o, _mm_and_si128(nan, _mm_set1_epi32(F32::QUIET_NAN)));
+    // subnormal: renormalize through the FPU
+    const __m128i sub = _mm_cmpeq_epi32(e, _mm_setzero_si128());
+    const __m128 s = _mm_sub_ps(
+        _mm_castsi128_ps(_mm_add_epi32(o, _mm_set1_epi32(1 << 23))),
+        _mm_castsi128_ps(MAGIC));
+    o = Select(sub, _mm_castps_si128(s), o);
+    const __m128i sign =
+        _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(F16::BIT_MASK)), 16);
+    return _mm_castsi128_ps(_mm_or_si128(o, sign));
+}
+
+inline __m128i FloatToBFloat16SSE(__m128 f) {
+    const __m128i u = _mm_castps_si128(f);
+    const __m128i lsb = _mm_and_si128(_mm_srli_epi32(u, 16), _mm_set1_epi32(1));
+    const __m128i r = _mm_srli_epi32(
+        _mm_add_epi32(_mm_add_epi32(u, _mm_set1_epi32(0x7FFF)), lsb), 16);
+    const __m128i q = _mm_srli_epi32(
+        _mm_or_si128(u, _mm_set1_epi32(F32::QUIET_NAN)), 16);
+    const __m128i nan = _mm_castps_si128(_mm_cmpunord_ps(f, f));
+    return Select(nan, q, r);
+}
+}  // namespace
+
+void FloatToHalfSSE(const float* in, uint16_t* out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m128i a = FloatToHalfSSE(_mm_loadu_ps(in + i));
+        const __m128i b = FloatToHalfSSE(_mm_loadu_ps(in + i + 4));
+        _mm_storeu_si128((__m128i*)(out + i), Pack32To16(a, b));
+    }
+    FloatToHalfScalar(in + i, out + i, n - i);
+}
+
+void HalfToFloatSSE(const uint16_t* in, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m128i h = _mm_loadu_si128((const __m128i*)(in + i));
+        const __m128i z = _mm_setzero_si128();
+        _mm_storeu_ps(out + i, HalfToFloatSSE(_mm_unpacklo_epi16(h, z)));
+        _mm_storeu_ps(out + i + 4, HalfToFloatSSE(_mm_unpackhi_epi16(h, z)));
+    }
+    HalfToFloatScalar(in + i, out + i, n - i);
+}
+
+void FloatToBFloat16SSE(const float* in, uint16_t* out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m128i a = FloatToBFloat16SSE(_mm_loadu_ps(in + i));
+        const __m128i b = FloatToBFloat16SSE(_mm_loadu_ps(in + i + 4));
+        _mm_storeu_si128((__m128i*)(out + i), Pack32To16(a, b));
+    }
+    FloatToBFloat16Scalar(in + i, out + i, n - i);
+}
+
+void BFloat16ToFloatSSE(const uint16_t* in, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m128i h = _mm_loadu_si128((const __m128i*)(in + i));
+        const __m128i z = _mm_setzero_si128();
+        _mm_storeu_si128((__m128i*)(out + i), _mm_unpacklo_epi16(z, h));
+        _mm_storeu_si128((__m128i*)(out + i + 4), _mm_unpackhi_epi16(z, h));
+    }
+    BFloat16ToFloatScalar(in + i, out + i, n - i);
+}
+
+//------------------------------------------------------------------------------
+// AVX2/F16C kernels, 16 values per step; F16C does float16 in hardware,
+// bfloat16 is the SSE code at twice the width
+__attribute__((target("avx2,f16c"))) void FloatToHalfAVX2(const float* in,
+                                                          uint16_t* out,
+                                                          size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i a =
+            _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT);
+        const __m128i b = _mm256_cvtps_ph(_mm256_loadu_ps(in + i + 8),
+                                          _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128((__m128i*)(out + i), a);
+        _mm_storeu_si128((__m128i*)(out + i + 8), b);
+    }
+    FloatToHalfScalar(in + i, out + i, n - i);
+}
+
+__attribute__((target("avx2,f16c"))) void HalfToFloatAVX2(const uint16_t* in,
+                                                          float* out,
+                                                          size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i a = _mm_loadu_si128((const __m128i*)(in + i));
+        const __m128i b = _mm_loadu_si128((const __m128i*)(in + i + 8));
+        _mm256_storeu_ps(out + i, _mm256_cvtph_ps(a));
+        _mm256_storeu_ps(out + i + 8, _mm256_cvtph_ps(b));
+    }
+    HalfToFloatScalar(in + i, out + i, n - i);
+}
+
+__attribute__((target("avx2"))) inline __m256i FloatToBFloat16AVX2(
+    __m256 f) {
+    const __m256i u = _mm256_castps_si256(f);
+    const __m256i lsb =
+        _mm256_and_si256(_mm256_srli_epi32(u, 16), _mm256_set1_epi32(1));
+    const __m256i r = _mm256_srli_epi32(
+        _mm256_add_epi32(_mm256_add_epi32(u, _mm256_set1_epi32(0x7FFF)),
+                         lsb),
+        16);
+    const __m256i q = _mm256_srli_epi32(
+        _mm256_or_si256(u, _mm256_set1_epi32(F32::QUIET_NAN)), 16);
+    const __m256i nan =
+        _mm256_castps_si256(_mm256_cmp_ps(f, f, _CMP_UNORD_Q));
+    return _mm256_blendv_epi8(r, q, nan);
+}
+
+__attribute__((target("avx2"))) void FloatToBFloat16AVX2(const float* in,
+                                                         uint16_t* out,
+                                                         size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m256i a = FloatToBFloat16AVX2(_mm256_loadu_ps(in + i));
+        const __m256i b = FloatToBFloat16AVX2(_mm256_loadu_ps(in + i + 8));
+        // packus works within 128 bit lanes: restore order afterwards
+        const __m256i p = _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b),
+                                                   _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256((__m256i*)(out + i), p);
+    }
+    FloatToBFloat16Scalar(in + i, out + i, n - i);
+}
+
+__attribute__((target("avx2"))) void BFloat16ToFloatAVX2(const uint16_t* in,
+                                                         float* out,
+                                                         size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i a = _mm_loadu_si128((const __m128i*)(in + i));
+        const __m128i b = _mm_loadu_si128((const __m128i*)(in + i + 8));
+        _mm256_storeu_si256((__m256i*)(out + i),
+                            _mm256_slli_epi32(_mm256_cvtepu16_epi32(a), 16));
+        _mm256_storeu_si256((__m256i*)(out + i + 8),
+                            _mm256_slli_epi32(_mm256_cvtepu16_epi32(b), 16));
+    }
+    BFloat16ToFloatScalar(in + i, out + i, n - i);
+}
+#endif
+
+//------------------------------------------------------------------------------
+// Kernel selection: best available at runtime unless explicitly requested
+enum class Kernel { SCALAR, SSE, AVX2 };
+
+const char* Name(Kernel k) {
+    switch (k) {
+        case Kernel::SCALAR:
+            return "scalar";
+        case Kernel::SSE:
+            return "SSE2";
+        case Kernel::AVX2:
+            return "AVX2/F16C";
+    }
+    return "";
+}
+
+bool Supported(Kernel k) {
+#ifdef FLOAT16_X86
+    switch (k) {
+        case Kernel::SCALAR:
+            return true;
+        case Kernel::SSE:
+            return __builtin_cpu_supports("sse2");
+        case Kernel::AVX2:
+            return __builtin_cpu_supports("avx2") &&
+                   __builtin_cpu_supports("f16c");
+    }
+    return false;
+#else
+    return k == Kernel::SCALAR;
+#endif
+}
+
+Kernel BestKernel() {
+    static const Kernel best = Supported(Kernel::AVX2)  ? Kernel::AVX2
+                               : Supported(Kernel::SSE) ? Kernel::SSE
+                                                        : Kernel::SCALAR;
+    return best;
+}
+
+using NarrowF = void (*)(const float*, uint16_t*, size_t);
+using WidenF = void (*)(const uint16_t*, float*, size_t);
+
+struct Kernels {
+    NarrowF toHalf;
+    WidenF fromHalf;
+    NarrowF toBFloat16;
+    WidenF fromBFloat16;
+};
+
+const Kernels& Get(Kernel k) {
+    static const Kernels SCALAR = {FloatToHalfScalar, HalfToFloatScalar,
+                                   FloatToBFloat16Scalar,
+                                   BFloat16ToFloatScalar};
+#ifdef FLOAT16_X86
+    static const Kernels SSE = {FloatToHalfSSE, HalfToFloatSSE,
+                                FloatToBFloat16SSE, BFloat16ToFloatSSE};
+    static const Kernels AVX2 = {FloatToHalfAVX2, HalfToFloatAVX2,
+                                 FloatToBFloat16AVX2, BFloat16ToFloatAVX2};
+    if (k == Kernel::AVX2) return AVX2;
+    if (k == Kernel::SSE) return SSE;
+#endif
+    return SCALAR;
+}
+
+void FloatToHalf(const float* in, uint16_t* out, size_t n,
+                 Kernel k = BestKernel()) {
+    Get(k).toHalf(in, out, n);
+}
+void HalfToFloat(const uint16_t* in, float* out, size_t n,
+                 Kernel k = BestKernel()) {
+    Get(k).fromHalf(in, out, n);
+}
+void FloatToBFloat16(const float* in, uint16_t* out, size_t n,
+                     Kernel k = BestKernel()) {
+    Get(k).toBFloat16(in, out, n);
+}
+void BFloat16ToFloat(const uint16_t* in, float* out, size_t n,
+                     Kernel k = BestKernel()) {
+    Get(k).fromBFloat16(in, out, n);
+}
+
+//------------------------------------------------------------------------------
+using Clock = chrono::high_resolution_clock;
+template <typename TimeDiffNsT>
+constexpr double NsToSec(const TimeDiffNsT& diff) {
+    return double(chrono::duration_cast<chrono::nanoseconds>(diff).count()) /
+           1E9;
+}
+
+vector<Kernel> SupportedKernels() {
+    vector<Kernel> kernels;
+    for (Kernel k : {Kernel::SCALAR, Kernel::SSE, Kernel::AVX2})
+        if (Supported(k)) kernels.push_back(k);
+    return kernels;
+}
+
+// Every kernel must match the scalar reference bit for bit on all 2^32
+// floats and all 2^16 16 bit patterns; also report round trip error
+bool Accuracy() {
+    const size_t CHUNK = size_t(1) << 20;
+    vector<float> in(CHUNK), back(CHUNK);
+    vector<uint16_t> ref(CHUNK), out(CHUNK);
+    size_t mismatches = 0;
+    const auto kernels = SupportedKernels();
+    for (int format = 0; format != 2; ++format) {
+        NarrowF Kernels::*narrow =
+            format ? &Kernels::toBFloat16 : &Kernels::toHalf;
+        WidenF Kernels::*widen =
+            format ? &Kernels::fromBFloat16 : &Kernels::fromHalf;
+        // narrowing, all floats
+        double maxRelError = 0;
+        uint64_t overflows = 0, flushed = 0;
+        for (uint64_t base = 0; base < (uint64_t(1) << 32); base += CHUNK) {
+            for (size_t i = 0; i != CHUNK; ++i)
+                in[i] = BitsToFloat<float>(uint32_t(base + i));
+            (Get(Kernel::SCALAR).*narrow)(in.data(), ref.data(), CHUNK);
+            for (Kernel k : kernels) {
+                if (k == Kernel::SCALAR) continue;
+                (Get(k).*narrow)(in.data(), out.data(), CHUNK);
+                for (size_t i = 0; i != CHUNK; ++i)
+                    mismatches += ref[i] != out[i];
+            }
+            (Get(Kernel::SCALAR).*widen)(ref.data(), back.data(), CHUNK);
+            for (size_t i = 0; i != CHUNK; ++i) {
+                if (!isfinite(in[i])) continue;
+                if (isinf(back[i])) {
+                    ++overflows;
+                } else if (in[i] != 0 && back[i] == 0) {
+                    ++flushed;
+                } else if (fabs(in[i]) >= (format ? FLT_MIN : 0x1p-14f)) {
+                    maxRelError = max(
+                        maxRelError, fabs(double(back[i]) - in[i]) / fabs(in[i]));
+                }
+            }
+        }
+        // widening and round trip, all 16 bit patterns
+        vector<uint16_t> all(1 << 16), rt(1 << 16);
+        vector<float> wide(1 << 16), wref(1 << 16);
+        for (size_t i = 0; i != all.size(); ++i) all[i] = uint16_t(i);
+        (Get(Kernel::SCALAR).*widen)(all.data(), wref.data(), all.size());
+        for (Kernel k : kernels) {
+            (Get(k).*widen)(all.data(), wide.data(), all.size());
+            for (size_t i = 0; i != all.size(); ++i)
+                mismatches += FloatToBits(wide[i]) != FloatToBits(wref[i]);
+        }
+        (Get(Kernel::SCALAR).*narrow)(wref.data(), rt.data(), rt.size());
+        size_t roundTripErrors = 0;
+        const uint16_t quiet = format ? uint16_t(BF16::QUIET_NAN)
+                                      : uint16_t(F16::QUIET_NAN);
+        for (size_t i = 0; i != all.size(); ++i) {
+            const bool nan = isnan(wref[i]);
+            roundTripErrors += nan ? rt[i] != (all[i] | quiet)
+                                   : rt[i] != all[i];
+        }
+        mismatches += roundTripErrors;
+        const int bits = 1 + (format ? int(BF16::MANTISSA_LENGTH)
+                                     : int(F16::MANTISSA_LENGTH));
+        cout << (format ? "bfloat16" : "float16") << ":" << endl
+             << "  max relative error (normal range): " << maxRelError
+             << " (bound 2^-" << bits << " = " << ldexp(1.0, -bits) << ")"
+             << endl
+             << "  finite floats overflowing to inf: " << overflows << endl
+             << "  non-zero floats flushed to zero:  " << flushed << endl
+             << "  16 -> 32 -> 16 bit round trip errors: " << roundTripErrors
+             << endl;
+    }
+    cout << "kernel mismatches vs scalar: " << mismatches << endl;
+    return mismatches == 0;
+}
+
+template <typename F>
+double Throughput(size_t bytes, F f) {
+    f();  // page in output
+    const int REPEAT = 5;
+    const auto start = Clock::now();
+    for (int r = 0; r != REPEAT; ++r) f();
+    return REPEAT * bytes / NsToSec(Clock::now() - start) / 1E9;
+}
+
+void Benchmark(size_t n) {
+    mt19937 gen(42);
+    normal_distribution<float> dist(0.f, 1000.f);
+    vector<float> in(n), back(n);
+    vector<uint16_t> out(n);
+    for (auto& f : in) f = dist(gen);
+    // bytes read + written
+    const size_t bytes = n * (sizeof(float) + sizeof(uint16_t));
+    cout << n << " values, GB/s (read + write)" << endl;
+    cout << "  kernel      f32->f16  f16->f32  f32->bf16  bf16->f32" << endl;
+    for (Kernel k : SupportedKernels()) {
+        const Kernels& K = Get(k);
+        cout << "  " << Name(k) << string(12 - strlen(Name(k)), ' ');
+        cout << Throughput(bytes, [&] { K.toHalf(in.data(), out.data(), n); })
+             << "  ";
+        cout << Throughput(bytes,
+                           [&] { K.fromHalf(out.data(), back.data(), n); })
+             << "  ";
+        cout << Throughput(bytes,
+                           [&] { K.toBFloat16(in.data(), out.data(), n); })
+             << "  ";
+        cout << Throughput(bytes, [&] {
+            K.fromBFloat16(out.data(), back.data(), n);
+        }) << endl;
+    }
+    cout << "memcpy of float array: "
+         << Throughput(2 * n * sizeof(float),
+                       [&] {
+                           memcpy(back.data(), in.data(), n * sizeof(float));
+                       })
+         << " GB/s" << endl;
+}
+
+//------------------------------------------------------------------------------
+int main(int argc, char const* argv[]) {
+    const float values[] = {1.f, -2.5f, 65504.f, 65520.f, 0x1p-24f, 3.14159f};
+    uint16_t h[6], b[6];
+    float hf[6], bf[6];
+    FloatToHalf(values, h, 6);
+    FloatToBFloat16(values, b, 6);
+    HalfToFloat(h, hf, 6);
+    BFloat16ToFloat(b, bf, 6);
+    cout << "kernel: " << Name(BestKernel()) << endl;
+    for (int i = 0; i != 6; ++i) {
+        cout << values[i] << " -> float16 " << hf[i] << ", bfloat16 " << bf[i]
+             << endl;
+    }
+    bool ok = true;
+    for (int a = 1; a < argc; ++a) {
+        const string arg = argv[a];
+        if (arg == "accuracy") ok = Accuracy() && ok;
+        if (arg == "bench") {
+            const size_t n =
+                a + 1 < argc ? stoull(argv[a + 1]) : size_t(1) << 26;
+            Benchmark(n);
+        }
+    }
+    return ok ? 0 : 1;
+}
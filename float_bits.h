@@ -0,0 +1,223 @@
+//
+// IEEE-754 binary32/binary64 layout traits and constexpr float <--> bits
+// conversion, compatible with non-type template parameters:
+// MyType<IntFloat(1.345f)> mt;
+// Author: Ugo Varetto
+//
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#if __cplusplus >= 202002L
+#include <bit>
+#endif
+
+//------------------------------------------------------------------------------
+// bits:
+// |31  |30........23|22.....0|     |63  |62........52|51.....0|
+// |sign|exponent+127|mantissa|     |sign|exponent+1023|mantissa|
+// F = -1^sign x 2^exponent x 1.mantissa : normalized
+// F = -1^sign x 2^(1-offset) x 0.mantissa : subnormal, exponent bits = 0
+// exponent bits all set: infinite if mantissa == 0, NaN otherwise
+template <typename T>
+struct FloatTraits {};
+
+template <>
+struct FloatTraits<float> {
+    enum : int32_t { SIGN_BIT = 31, MANTISSA_LENGTH = 23, EXP_LENGTH = 8 };
+    // after right shift
+    enum : uint32_t {
+        BIT_MASK = 0x80000000,
+        MANTISSA_MASK = 0x007FFFFF,
+        EXP_MASK = 0x000000FF
+    };
+    enum : int32_t { EXP_OFFSET = 127 };
+    enum : int32_t { MIN_EXP = 126 };
+    enum : uint32_t {
+        POSITIVE_INFINITE = 0x7F800000,
+        NEGATIVE_INFINITE = 0xFF800000,
+        QUIET_NAN = 0x7FC00000
+    };
+    using IntType = int32_t;
+    using UIntType = uint32_t;
+};
+
+template <>
+struct FloatTraits<double> {
+    enum : int64_t { SIGN_BIT = 63, MANTISSA_LENGTH = 52, EXP_LENGTH = 11 };
+    // after right shift
+    enum : uint64_t {
+        BIT_MASK = 0x8000000000000000,
+        MANTISSA_MASK = 0x000FFFFFFFFFFFFF,
+        EXP_MASK = 0x00000000000007FF
+    };
+    enum : int64_t { EXP_OFFSET = 1023 };
+    enum : int64_t { MIN_EXP = 1022 };
+    enum : uint64_t {
+        POSITIVE_INFINITE = 0x7FF0000000000000,
+        NEGATIVE_INFINITE = 0xFFF0000000000000,
+        QUIET_NAN = 0x7FF8000000000000
+    };
+    using IntType = int64_t;
+    using UIntType = uint64_t;
+};
+
+//------------------------------------------------------------------------------
+// Use a real bit cast when the compiler offers one (std::bit_cast in C++20,
+// __builtin_bit_cast in GCC >= 11 and clang >= 9 in any mode), fall back to
+// the exact arithmetic path below otherwise; define FLOAT_BITS_NO_BIT_CAST
+// to force the arithmetic path
+#ifndef FLOAT_BITS_NO_BIT_CAST
+#if defined(__cpp_lib_bit_cast)
+#define FLOAT_BITS_CAST(To, x) std::bit_cast<To>(x)
+#elif defined(__has_builtin)
+#if __has_builtin(__builtin_bit_cast)
+#define FLOAT_BITS_CAST(To, x) __builtin_bit_cast(To, x)
+#endif
+#endif
+#endif
+
+namespace float_bits_detail {
+//------------------------------------------------------------------------------
+// 2^(2^i) and 2^-(2^i) for i in [0, EXP_LENGTH - 2]: enough to scale by any
+// power of two in (-2^(EXP_LENGTH - 1), 2^(EXP_LENGTH - 1))
+template <typename T>
+struct Powers {
+    enum : int { SIZE = int(FloatTraits<T>::EXP_LENGTH) - 1 };
+    T up[SIZE] = {};
+    T down[SIZE] = {};
+    constexpr Powers() {
+        T p = T(2);
+        for (int i = 0; i != SIZE; ++i) {
+            up[i] = p;
+            down[i] = T(1) / p;
+            if (i + 1 != SIZE) p *= p;
+        }
+    }
+};
+
+template <typename T>
+constexpr Powers<T> POWERS{};
+
+//------------------------------------------------------------------------------
+// x * 2^n, |n| <= EXP_OFFSET, one multiplication per bit of |n| with the
+// smallest powers first: every partial product lies between x and the result,
+// hence it is exact whenever the result is representable
+template <typename T>
+constexpr T Scale(T x, int n) {
+    const T* p = n > 0 ? POWERS<T>.up : POWERS<T>.down;
+    for (n = n > 0 ? n : -n; n; n >>= 1, ++p) {
+        if (n & 1) x *= *p;
+    }
+    return x;
+}
+
+//------------------------------------------------------------------------------
+// Exact encoding with a fixed number of steps (EXP_LENGTH - 1):
+// 1) NaN, infinite and zero are detected by comparison
+// 2) subnormals: |F| x 2^(MIN_EXP + MANTISSA_LENGTH) is the mantissa
+// 3) normalized: find the exponent E one bit at a time by scaling |F| by
+//    2^-64, 2^-32 ... 2^-1 (float) while >= 1 or by 2^64 ... 2^1 while < 2,
+//    |F| ends up in [1, 2) and (|F| - 1) x 2^MANTISSA_LENGTH is the mantissa
+// Without a bit cast -0 cannot be told apart from +0 and NaN payloads are
+// not observable: -0 encodes as +0, every NaN as the canonical quiet NaN
+template <typename T>
+constexpr typename FloatTraits<T>::UIntType ToBits(const T f) {
+    using FT = FloatTraits<T>;
+    using U = typename FT::UIntType;
+    constexpr int M = int(FT::MANTISSA_LENGTH);
+    constexpr int BIAS = int(FT::EXP_OFFSET);
+    constexpr auto& P = POWERS<T>;
+    constexpr T TO_MANTISSA = Scale(T(1), M);
+    constexpr T TO_SUBNORMAL = Scale(T(1), int(FT::MIN_EXP));
+    if (f != f) return U(FT::QUIET_NAN);
+    const U S = f < 0 ? U(FT::BIT_MASK) : U(0);
+    T a = f < 0 ? -f : f;
+    if (a == T(0)) return S;
+    if (a > std::numeric_limits<T>::max()) return S | U(FT::POSITIVE_INFINITE);
+    if (a < std::numeric_limits<T>::min())
+        return S | U(a * TO_SUBNORMAL * TO_MANTISSA);
+    int E = 0;
+    if (a >= T(2)) {
+        for (int i = P.SIZE - 1; i >= 0; --i) {
+            const T s = a * P.down[i];
+            const bool take = s >= T(1);
+            a = take ? s : a;
+            E += take << i;
+        }
+    } else if (a < T(1)) {
+        for (int i = P.SIZE - 1; i >= 0; --i) {
+            const T s = a * P.up[i];
+            const bool take = s < T(2);
+            a = take ? s : a;
+            E -= take << i;
+        }
+    }
+    return S | (U(E + BIAS) << M) | U((a - T(1)) * TO_MANTISSA);
+}
+
+//------------------------------------------------------------------------------
+// Exact decoding: mantissa (with implicit 1 if normalized) x 2^-23 x 2^E
+template <typename T>
+constexpr T FromBits(const typename FloatTraits<T>::UIntType u) {
+    using FT = FloatTraits<T>;
+    using U = typename FT::UIntType;
+    constexpr int M = int(FT::MANTISSA_LENGTH);
+    constexpr int BIAS = int(FT::EXP_OFFSET);
+    constexpr T FROM_MANTISSA = Scale(T(1), -M);
+    constexpr T FROM_SUBNORMAL = Scale(T(1), -int(FT::MIN_EXP));
+    const int E = int((u >> M) & U(FT::EXP_MASK));
+    const U mantissa = u & U(FT::MANTISSA_MASK);
+    T r = T(0);
+    if (E == int(FT::EXP_MASK)) {
+        r = mantissa ? std::numeric_limits<T>::quiet_NaN()
+                     : std::numeric_limits<T>::infinity();
+    } else if (E == 0) {
+        r = T(mantissa) * FROM_MANTISSA * FROM_SUBNORMAL;
+    } else {
+        r = Scale(T(mantissa | (U(1) << M)) * FROM_MANTISSA, E - BIAS);
+    }
+    return (u & U(FT::BIT_MASK)) ? -r : r;
+}
+}  // namespace float_bits_detail
+
+//------------------------------------------------------------------------------
+// Arithmetic-only conversions, always available; exposed for testing and
+// timing against the bit cast versions
+template <typename T>
+constexpr typename FloatTraits<T>::UIntType FloatToBitsArithmetic(const T f) {
+    return float_bits_detail::ToBits(f);
+}
+
+template <typename T>
+constexpr T BitsToFloatArithmetic(const typename FloatTraits<T>::UIntType u) {
+    return float_bits_detail::FromBits<T>(u);
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+constexpr typename FloatTraits<T>::UIntType FloatToBits(const T f) {
+#ifdef FLOAT_BITS_CAST
+    return FLOAT_BITS_CAST(typename FloatTraits<T>::UIntType, f);
+#else
+    return float_bits_detail::ToBits(f);
+#endif
+}
+
+template <typename T>
+constexpr T BitsToFloat(const typename FloatTraits<T>::UIntType u) {
+#ifdef FLOAT_BITS_CAST
+    return FLOAT_BITS_CAST(T, u);
+#else
+    return float_bits_detail::FromBits<T>(u);
+#endif
+}
+
+//------------------------------------------------------------------------------
+// Convert 32 bit floating point number to 32 bit unsigned int. Can be used
+// in template parameter lists or any other scope requiring a constexpr.
+constexpr uint32_t IntFloat(const float f) { return FloatToBits(f); }
+
+// Convert 32 bit unsigned integer to 32 bit floating point number.
+constexpr float FloatInt(const uint32_t i) { return BitsToFloat<float>(i); }
@@ -1,96 +1,31 @@
 //
-// constexpr 32 bit float <--> 32 bit int bitwise conversion, compatible with
-// non-type template parameters: MyType<IntFloat(1.345f)> mt; 
+// constexpr 32/64 bit float <--> 32/64 bit int bitwise conversion, compatible
+// with non-type template parameters: MyType<IntFloat(1.345f)> mt;
+// Conversion engine in float_bits.h, this file checks it exhaustively over
+// all 2^32 float bit patterns and times it.
+// Usage: float_constexpr [exhaustive] [bench [num values]]
+// Compile time: time the build with and without
+// -DFLOAT_CONSTEXPR_STRESS=<number of conversions>, add
+// -DFLOAT_BITS_NO_BIT_CAST to time the arithmetic path
 // Author: Ugo Varetto
 //
 
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cinttypes>
+#include <cmath>
+#include <cstring>
 #include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
 
-using namespace std;
+#include "bit_dump.h"
+#include "float_bits.h"
 
-//------------------------------------------------------------------------------
-// Convert 32 bit floating point number to 32 bit unsigned int. Can be used
-// in template parameter lists or any other scope requiring a constexpr.
-// bits:
-// |31  |30........23|22.....0|
-//   ^        ^          ^
-// |sign|exponent-127|mantissa|
-// F = -1^sign x 2^exponent x 1. mantissa : normalized, x 1.****
-// denormalized: exponent = 0, F = -1^sign x 2^-126 * 0.mantissa
-// denormalization not supported, only floating point numbers with integer
-// part in signed 32 bit integer range supported
-// Algorithm, given floating point number F:
-// 1) extract sign, integer part, mantissa
-// 2) compute exponent E:
-//  2.1) if integer part >= 1 keep on incrementing the exponent E
-//       until 2^E < Integer(F), then decrement E to find the biggest exponent
-//       for which 2^E < F
-//  2.2) if integer part == 0 keep on incrementing the exponent E
-//       until 1/2^E > Mantissa(F)
-// 3) compute mantissa, F' = |F|:
-//  3.0) initialize number N to 2^E or 2^(-E) if number < 1,
-//       mantissa and mask to 0
-//  3.1) for each bit from position 22 to 0, while N != F:
-//         if N * (1 + mantissa + 1/2^bit_i) <= F'
-//           set bit i in mask to 1
-//           mantissa = mantissa + 1/2^bit_i
-//           N = N * (1 + mantissa + 1/2^bit_i)
-// 4) if |F| < 1 exponent is negative: E = -E
-// 5) return bitwise or of (sign << 31, E + 127 << 23, mantissa)
-// As per IEEE754 specification 127 is subtracted from exponent value, so
-// it needs to be added back
-// No encoding for NaN, subnormals or infinite yet
-constexpr uint32_t IntFloat(const float f) {
-    const uint32_t S = (1 << 31) & int32_t(f);
-    uint32_t I = S ? -int32_t(f) : int32_t(f);
-    float M = S ? -f - I : f - I;
-    int E = 0;
-    if (I > 0) {
-        while ((1 << E) < I) ++E;
-        E = E > 0 ? E - 1 : 0;
-    } else {
-        E = 1;
-        while (1.f / (1 << E) > M) ++E;
-    }
-    const float F = I + M;
-    float N = I > 0 ? 1 << E : (1.f / (1 << E));
-    float m = 0.f;
-    uint32_t mask = 0;
-    for (int bit = 1; bit != 24; ++bit) {
-        const float r = 1.f / (1 << bit);
-        const float n = N * (1.f + m + r);
-        if (F - n >= 0) {
-            mask |= 1 << (23 - bit);
-            m += r;
-        }
-        if (F == n) break;
-    }
-    E = I > 0 ? E : -E;
-    const uint32_t x = ((E + 127) & 0x0000000FF) << 23;
-    return S | x | mask;
-}
-
-//------------------------------------------------------------------------------
-// Convert 32 bit unsigned integer to 32 bit floating point number.
-// Can be used in template parameter list or any other scope requiring
-// a constexpr.
-// Extract sign and exponent and sum bits in
-// mantissa (sum of 1/2^(22-bit position + 1)) where bit position in [0,22]
-// No decoding for NaN, subnormals or infinite yet
-constexpr float FloatInt(const uint32_t i) {
-    const float sign = (1 << 31) & i ? -1.f : 1.f;
-    int e = (((i & 0x7FFFFFFF) >> 23) & 0x000000FF) - 127;
-    const float factor = e > 0 ? 1 << e : 1.f / (1 << -e);
-    float m = 0.f;
-    for (int bit = 0; bit != 23; ++bit) {
-        const int offset = 22 - bit;
-        const int b = (i & (1 << offset)) >> offset;
-        if (b) m += 1.f / (1 << (bit + 1));
-    }
-    return sign * factor * (1.f + m);
-}
+using namespace std;
 
 //------------------------------------------------------------------------------
 template <uint32_t F>
@@ -100,35 +35,153 @@ struct Float {
 };
 
 //------------------------------------------------------------------------------
-template <typename T>
-void PrintBits(const T n, int start = 0, const int end = 8 * sizeof(T) - 1) {
-    static_assert(is_integral<T>::value);
-    for (int i = end; i >= start; --i) {
-        const int v = (n & (1 << i)) >> i;
-        cout << v;
+// WARNING: user defined literals for numeric types require the argument to
+// always be positive, use _nf for negative numbers
+constexpr uint32_t operator"" _f(long double v) { return IntFloat(float(v)); }
+// convert float to negative int
+constexpr uint32_t operator"" _nf(long double v) { return IntFloat(float(-v)); }
+
+//------------------------------------------------------------------------------
+static_assert(IntFloat(1.f) == 0x3F800000);
+static_assert(IntFloat(-2.5f) == 0xC0200000);
+static_assert(IntFloat(numeric_limits<float>::infinity()) ==
+              FloatTraits<float>::POSITIVE_INFINITE);
+static_assert(IntFloat(numeric_limits<float>::denorm_min()) == 1);
+static_assert(IntFloat(numeric_limits<float>::max()) == 0x7F7FFFFF);
+static_assert(FloatInt(0x00400000) == numeric_limits<float>::min() / 2);
+static_assert(FloatInt(FloatTraits<float>::QUIET_NAN) !=
+              FloatInt(FloatTraits<float>::QUIET_NAN));
+static_assert(FloatToBits(1.0) == 0x3FF0000000000000);
+static_assert(FloatToBits(numeric_limits<double>::denorm_min()) == 1);
+static_assert(BitsToFloat<double>(0xC000000000000000) == -2.0);
+static_assert(FloatToBitsArithmetic(-10.234f) == IntFloat(-10.234f));
+static_assert(FloatToBitsArithmetic(numeric_limits<float>::denorm_min()) == 1);
+static_assert(FloatToBitsArithmetic(1e-310) == FloatToBits(1e-310));
+static_assert(BitsToFloatArithmetic<float>(0x80000001) ==
+              -numeric_limits<float>::denorm_min());
+static_assert(BitsToFloatArithmetic<double>(0x7FEFFFFFFFFFFFFF) ==
+              numeric_limits<double>::max());
+
+#ifdef FLOAT_CONSTEXPR_STRESS
+template <int N>
+constexpr uint32_t ConstexprChecksum() {
+    uint32_t s = 0;
+    for (int i = 0; i != N; ++i) {
+        s ^= IntFloat(float(i) * 0.37f);
+        s ^= IntFloat(FloatInt(uint32_t(i) * 2654435761u));
     }
+    return s;
 }
+constexpr uint32_t CONSTEXPR_CHECKSUM =
+    ConstexprChecksum<FLOAT_CONSTEXPR_STRESS>();
+#endif
 
-template <typename T, int...Separators>
-void PrintBitsSep(const T n) {
-    static_assert(is_integral<T>::value);
-    const int BITS = 8 * sizeof(T);
-    for (int i = BITS; i >= 0; --i) {
-        const int v = (n & (1 << i)) >> i;
-        cout << v;
-        if((... || (i == BITS - Separators))) {
-            cout << " ";
+//------------------------------------------------------------------------------
+using Clock = chrono::high_resolution_clock;
+template <typename TimeDiffNsT>
+constexpr double NsToSec(const TimeDiffNsT& diff) {
+    return double(chrono::duration_cast<chrono::nanoseconds>(diff).count()) /
+           1E9;
+}
+
+uint32_t MemcpyBits(float f) {
+    uint32_t i;
+    memcpy(&i, &f, sizeof(i));
+    return i;
+}
+
+// The arithmetic path cannot see the sign of zero or NaN payloads
+bool ArithmeticMatch(uint32_t expected, uint32_t actual) {
+    if (expected == 0x80000000) return actual == 0;
+    if (isnan(FloatInt(expected))) return actual == FloatTraits<float>::QUIET_NAN;
+    return expected == actual;
+}
+
+bool SameBits(float expected, float actual) {
+    return isnan(expected) ? bool(isnan(actual))
+                           : MemcpyBits(expected) == MemcpyBits(actual);
+}
+
+// Check both directions and both paths against memcpy for every 32 bit
+// pattern, range split evenly among hardware threads
+bool ExhaustiveTest() {
+    const uint64_t NUM_PATTERNS = uint64_t(1) << 32;
+    const unsigned numThreads = max(1u, thread::hardware_concurrency());
+    atomic<uint64_t> errors{0};
+    auto check = [&errors](uint64_t first, uint64_t last) {
+        uint64_t e = 0;
+        for (uint64_t p = first; p != last; ++p) {
+            const uint32_t u = uint32_t(p);
+            float f;
+            memcpy(&f, &u, sizeof(f));
+            const bool nan = isnan(f);
+            e += !(nan ? isnan(FloatInt(FloatToBits(f))) : FloatToBits(f) == u);
+            e += !SameBits(f, BitsToFloat<float>(u));
+            e += !ArithmeticMatch(u, FloatToBitsArithmetic(f));
+            e += !SameBits(f, BitsToFloatArithmetic<float>(u));
         }
+        errors += e;
+    };
+    const auto start = Clock::now();
+    vector<thread> threads;
+    const uint64_t chunk = NUM_PATTERNS / numThreads;
+    for (unsigned t = 0; t != numThreads; ++t) {
+        const uint64_t last = t + 1 == numThreads ? NUM_PATTERNS : chunk * (t + 1);
+        threads.emplace_back(check, chunk * t, last);
     }
+    for (auto& t : threads) t.join();
+    cout << "exhaustive test, " << numThreads << " threads: " << errors
+         << " errors, " << NsToSec(Clock::now() - start) << " s" << endl;
+    return errors == 0;
 }
 
-//------------------------------------------------------------------------------
-// WARNING: user defined literals for numeric types require the argument to
-// always be positive, use _nf for negative numbers
-constexpr uint32_t operator"" _f(long double v) { return IntFloat(float(v)); }
-// convert float to negative int
-constexpr uint32_t operator"" _nf(long double v) { return IntFloat(float(-v)); }
+template <typename F>
+void Time(const string& label, size_t n, F f) {
+    const auto start = Clock::now();
+    const uint64_t sink = f();
+    const double s = NsToSec(Clock::now() - start);
+    cout << label << ": " << 1E9 * s / n << " ns/value (" << sink << ")"
+         << endl;
+}
+
+void Benchmark(size_t n) {
+    mt19937 gen(42);
+    uniform_int_distribution<uint32_t> dist;
+    vector<uint32_t> bits(n);
+    vector<float> floats(n);
+    for (size_t i = 0; i != n; ++i) {
+        bits[i] = dist(gen);
+        memcpy(&floats[i], &bits[i], sizeof(float));
+    }
+    cout << "runtime, " << n << " values" << endl;
+    Time("  memcpy           float -> bits", n, [&] {
+        uint64_t s = 0;
+        for (float f : floats) s += MemcpyBits(f);
+        return s;
+    });
+    Time("  FloatToBits      float -> bits", n, [&] {
+        uint64_t s = 0;
+        for (float f : floats) s += FloatToBits(f);
+        return s;
+    });
+    Time("  arithmetic       float -> bits", n, [&] {
+        uint64_t s = 0;
+        for (float f : floats) s += FloatToBitsArithmetic(f);
+        return s;
+    });
+    Time("  BitsToFloat      bits -> float", n, [&] {
+        double s = 0;
+        for (uint32_t u : bits) s += BitsToFloat<float>(u & 0xBFFFFFFF);
+        return uint64_t(s != 0);
+    });
+    Time("  arithmetic       bits -> float", n, [&] {
+        double s = 0;
+        for (uint32_t u : bits) s += BitsToFloatArithmetic<float>(u & 0xBFFFFFFF);
+        return uint64_t(s != 0);
+    });
+}
 
+//------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
 int main(int argc, char const *argv[]) {
     union U {
@@ -140,10 +193,20 @@ int main(int argc, char const *argv[]) {
     assert(fi.i == IntFloat(fi.f));
     cout << "float number: " << fi.f << endl;
     cout << "float bits:   ";
-    PrintBitsSep<decltype(fi.i), 0, 8>(fi.i);
+    PrintBitsSep<decltype(fi.i), 1, 9>(fi.i);
     cout << endl;
     cout << "uint32_t:     " << fi.i << endl;
     Float<10.234_f> f;
     assert(float(f) == 10.234f);
-    return 0;
+    bool ok = true;
+    for (int a = 1; a < argc; ++a) {
+        const string arg = argv[a];
+        if (arg == "exhaustive") ok = ExhaustiveTest() && ok;
+        if (arg == "bench") {
+            const size_t n =
+                a + 1 < argc ? stoull(argv[a + 1]) : size_t(1) << 24;
+            Benchmark(n);
+        }
+    }
+    return ok ? 0 : 1;
 }
\ No newline at end of file
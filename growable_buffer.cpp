@@ -0,0 +1,100 @@
+//
+// Appending 64 KiB chunks up to a target size: std::vector<char>,
+// RawBuffer doubled through a new buffer and CopyBuffer, GrowableBuffer
+// (mremap, no copy); peak memory is about 2x the target size for vector
+// and RawBuffer
+// Usage: growable_buffer [target size in MiB, default 1024, 16384 for 16 GiB]
+// Author: Ugo Varetto
+//
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "growable_buffer.h"
+#include "raw_buffer.h"
+
+using namespace std;
+
+using Clock = chrono::high_resolution_clock;
+template <typename TimeDiffNsT>
+constexpr double NsToSec(const TimeDiffNsT& diff) {
+    return double(chrono::duration_cast<chrono::nanoseconds>(diff).count()) /
+           1E9;
+}
+
+//------------------------------------------------------------------------------
+// first bytes of each chunk, to check the content
+uint64_t Check(const char* p, size_t size, size_t chunk) {
+    uint64_t s = 0;
+    for (size_t i = 0; i < size; i += chunk) s += uint8_t(p[i]);
+    return s;
+}
+
+// GB/s
+template <typename AppendF>
+double Append(const vector<char>& chunk, size_t total, AppendF append) {
+    const auto start = Clock::now();
+    for (size_t n = 0; n < total; n += chunk.size()) {
+        if (!append(chunk.data(), chunk.size())) return -1;
+    }
+    return total / NsToSec(Clock::now() - start) / 1E9;
+}
+
+//------------------------------------------------------------------------------
+int main(int argc, char const* argv[]) {
+    const size_t total = (argc > 1 ? stoull(argv[1]) : 1024) << 20;
+    vector<char> chunk(64 << 10);
+    for (size_t i = 0; i != chunk.size(); ++i) chunk[i] = char(i * 13 + 1);
+    uint64_t c[3];
+    cout << setprecision(3) << "append throughput to " << (total >> 20)
+         << " MiB, GB/s" << endl
+         << "  vector<char>  RawBuffer + copy  GrowableBuffer" << endl;
+    double t[3];
+    {
+        vector<char> v;
+        t[0] = Append(chunk, total, [&](const char* p, size_t n) {
+            v.insert(v.end(), p, p + n);
+            return true;
+        });
+        c[0] = Check(v.data(), v.size(), chunk.size());
+    }
+    {
+        // RawBuffer is move constructible, not assignable
+        optional<RawBuffer> rb(in_place, chunk.size());
+        size_t size = 0;
+        t[1] = Append(chunk, total, [&](const char* p, size_t n) {
+            if (size + n > rb->Size()) {
+                RawBuffer bigger(2 * rb->Size());
+                if (!bigger.Size()) return false;
+                CopyBuffer(*rb, bigger);
+                rb.emplace(std::move(bigger));
+            }
+            memcpy(rb->Data() + size, p, n);
+            size += n;
+            return true;
+        });
+        c[1] = Check(rb->Data(), size, chunk.size());
+    }
+    {
+        GrowableBuffer gb;
+        t[2] = Append(chunk, total, [&](const char* p, size_t n) {
+            return gb.Append(p, n);
+        });
+        gb.ShrinkToFit();
+        c[2] = Check(gb.Data(), gb.Size(), chunk.size());
+    }
+    if (t[0] < 0 || t[1] < 0 || t[2] < 0) {
+        cerr << "ERROR: allocation failed" << endl;
+        return 1;
+    }
+    cout << setw(14) << t[0] << setw(18) << t[1] << setw(16) << t[2] << endl;
+    const bool ok = c[0] == c[1] && c[1] == c[2];
+    cout << (ok ? "results match" : "ERROR: results differ") << endl;
+    return ok ? 0 : 1;
+}
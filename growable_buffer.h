@@ -0,0 +1,108 @@
+// Author: Ugo Varetto
+// Growable raw buffer backed by an anonymous mapping: growing the capacity
+// calls mremap(MREMAP_MAYMOVE), which extends the mapping in place or moves
+// the page table entries to a new address range, the bytes are never
+// copied.
+// Capacity is a multiple of the page size; appending beyond the capacity
+// doubles it. Data() is page aligned and may change after any operation
+// that changes the capacity.
+// No exceptions: operations that allocate return false on failure and
+// leave the buffer unchanged.
+//   GrowableBuffer b;
+//   while (Read(chunk)) b.Append(chunk.data(), chunk.size());
+//   b.ShrinkToFit();
+
+#pragma once
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstring>
+
+class GrowableBuffer {
+   public:
+    GrowableBuffer() : data_(nullptr), size_(0), capacity_(0) {}
+    GrowableBuffer(const GrowableBuffer&) = delete;
+    GrowableBuffer& operator=(const GrowableBuffer&) = delete;
+    GrowableBuffer(GrowableBuffer&& other)
+        : data_(other.data_), size_(other.size_), capacity_(other.capacity_) {
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.capacity_ = 0;
+    }
+    ~GrowableBuffer() {
+        if (data_) munmap(data_, capacity_);
+    }
+    const char* Data() const { return data_; }
+    char* Data() { return data_; }
+    std::size_t Size() const { return size_; }
+    std::size_t Capacity() const { return capacity_; }
+    char& operator[](std::size_t i) { return data_[i]; }
+    char operator[](std::size_t i) const { return data_[i]; }
+
+    // capacity >= bytes
+    bool Reserve(std::size_t bytes) {
+        if (bytes <= capacity_) return true;
+        return Remap(RoundUp(bytes));
+    }
+    // new bytes are uninitialized (zero if never written before)
+    bool Resize(std::size_t size) {
+        if (size > capacity_ && !Reserve(Grow(size))) return false;
+        size_ = size;
+        return true;
+    }
+    bool Append(const void* p, std::size_t n) {
+        const std::size_t size = size_;
+        if (!Resize(size_ + n)) return false;
+        std::memcpy(data_ + size, p, n);
+        return true;
+    }
+    // capacity = size rounded up to a page, unmapped if empty
+    bool ShrinkToFit() {
+        const std::size_t c = RoundUp(size_);
+        if (c == capacity_) return true;
+        if (c == 0) {
+            munmap(data_, capacity_);
+            data_ = nullptr;
+            capacity_ = 0;
+            return true;
+        }
+        return Remap(c);
+    }
+
+   private:
+    static std::size_t RoundUp(std::size_t n) {
+        static const std::size_t page = std::size_t(sysconf(_SC_PAGESIZE));
+        return (n + page - 1) / page * page;
+    }
+    // at least size, at least twice the capacity
+    std::size_t Grow(std::size_t size) const {
+        return size > 2 * capacity_ ? size : 2 * capacity_;
+    }
+    bool Remap(std::size_t capacity) {
+        void* p;
+        if (data_) {
+            p = mremap(data_, capacity_, capacity, MREMAP_MAYMOVE);
+        } else {
+            p = mmap(nullptr, capacity, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        }
+        if (p == MAP_FAILED) return false;
+        data_ = static_cast<char*>(p);
+        capacity_ = capacity;
+        return true;
+    }
+
+   private:
+    char* data_;
+    std::size_t size_;
+    std::size_t capacity_;
+};
+
+inline char* begin(GrowableBuffer& b) { return b.Data(); }
+inline char* end(GrowableBuffer& b) { return b.Data() + b.Size(); }
+inline const char* begin(const GrowableBuffer& b) { return b.Data(); }
+inline const char* end(const GrowableBuffer& b) {
+    return b.Data() + b.Size();
+}
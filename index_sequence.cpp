@@ -6,36 +6,7 @@
 #include <iostream>
 #include <cassert>
 
-template <int H, int...I>
-struct Last : Last<I...>{};
-
-template<int I>
-struct Last<I> {
-    enum : int {value = I};
-};
-
-
-template <int... N>
-struct Idx {
-    const size_t size = sizeof...(N);
-    const int index[sizeof...(N)] = {N...};
-    int operator[](size_t i) const { return index[i]; }
-};
-
-template <int S, int... N>
-struct Sequence : Sequence<S - 1, N..., int(Last<N...>::value) + 1> {};
-
-template <int... N>
-struct Sequence<0, N...> {
-    using Index = Idx<N...>;
-};
-
-template <int Size, int Start = 0>
-struct MakeIndexSequence {
-    static_assert(Size > 0, "Size <= 0");
-    static_assert(Start < Size, "Start >= Size");
-    using Type = typename Sequence<Size - 1, Start>::Index;
-};
+#include "index_sequence.h"
 
 #if __cplusplus >= 201703L
 template <int...I>
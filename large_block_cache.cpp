@@ -0,0 +1,76 @@
+//
+// Allocate, write every page, free loop with large RawBuffers: no cache
+// (every buffer mapped and unmapped) vs large block cache keeping pages
+// resident, MADV_FREE and MADV_DONTNEED
+// Usage: large_block_cache [buffer size in MiB, default 256]
+//                          [iterations, default 20]
+// Author: Ugo Varetto
+//
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "raw_buffer.h"
+
+using namespace std;
+
+using Clock = chrono::high_resolution_clock;
+template <typename TimeDiffNsT>
+constexpr double NsToSec(const TimeDiffNsT& diff) {
+    return double(chrono::duration_cast<chrono::nanoseconds>(diff).count()) /
+           1E9;
+}
+
+//------------------------------------------------------------------------------
+// ms per iteration
+double Loop(size_t size, int iterations, uint64_t& check) {
+    const size_t page = size_t(sysconf(_SC_PAGESIZE));
+    check = 0;
+    const auto start = Clock::now();
+    for (int i = 0; i != iterations; ++i) {
+        RawBuffer b(size, page);
+        if (!b.Size()) return -1;
+        for (size_t p = 0; p < size; p += page) b[p] = char(i + p);
+        for (size_t p = 0; p < size; p += page) check += uint8_t(b[p]);
+    }
+    return 1E3 * NsToSec(Clock::now() - start) / iterations;
+}
+
+//------------------------------------------------------------------------------
+int main(int argc, char const* argv[]) {
+    const size_t size = (argc > 1 ? stoull(argv[1]) : 256) << 20;
+    const int iterations = argc > 2 ? stoi(argv[2]) : 20;
+    struct Config {
+        const char* name;
+        size_t retention;
+        LargeBlockRelease release;
+    };
+    const Config configs[] = {
+        {"no cache", 0, LargeBlockRelease::KEEP},
+        {"cache, keep pages", size, LargeBlockRelease::KEEP},
+        {"cache, MADV_FREE", size, LargeBlockRelease::FREE},
+        {"cache, MADV_DONTNEED", size, LargeBlockRelease::DONTNEED}};
+    LargeBlockCache& cache = LargeBlockCache::Instance();
+    cout << setprecision(3) << size / (1 << 20) << " MiB buffers, "
+         << "ms/iteration (allocate, write every page, free)" << endl;
+    uint64_t ref = 0;
+    bool ok = true;
+    for (const Config& c : configs) {
+        cache.Configure(c.retention, c.release);
+        uint64_t check;
+        const double t = Loop(size, iterations, check);
+        if (t < 0) {
+            cerr << "ERROR: allocation failed" << endl;
+            return 1;
+        }
+        if (&c == configs) ref = check;
+        ok = ok && check == ref;
+        cout << setw(22) << c.name << setw(10) << t << endl;
+        cache.Trim();
+    }
+    cout << (ok ? "results match" : "ERROR: results differ") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,175 @@
+// Author: Ugo Varetto
+// Cache of large anonymous mappings: freed blocks are kept mapped for reuse
+// instead of being unmapped, avoiding the mmap/munmap system calls and, when
+// pages are not released, the page faults and zeroing of the next
+// allocation of the same size.
+// Freed blocks are released according to LargeBlockRelease:
+// - KEEP:     pages stay resident, reuse is free
+// - FREE:     madvise(MADV_FREE), the kernel reclaims the pages only under
+//             memory pressure, reuse is free until then (falls back to
+//             DONTNEED on kernels without MADV_FREE)
+// - DONTNEED: madvise(MADV_DONTNEED), pages dropped immediately, reuse
+//             faults zero pages but skips the mapping
+// At most Retention() bytes of free blocks are kept, the oldest blocks are
+// unmapped first. A free block is reused for requests of at least half its
+// size.
+// Defaults: 8 GiB retention, so that the 4 GiB buffers of batch jobs are
+// kept, FREE, 1 MiB minimum block size.
+// RawBuffer allocates blocks of MinBytes() or more from here.
+//   LargeBlockCache::Instance().Configure(size_t(8) << 30,
+//                                         LargeBlockRelease::FREE);
+
+#pragma once
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+enum class LargeBlockRelease { KEEP, FREE, DONTNEED };
+
+class LargeBlockCache {
+   public:
+    // never destroyed: buffers may be freed by static destructors
+    static LargeBlockCache& Instance() {
+        static LargeBlockCache* cache = new LargeBlockCache;
+        return *cache;
+    }
+    // retention 0 disables caching: every block is unmapped when freed
+    void Configure(std::size_t retention, LargeBlockRelease release,
+                   std::size_t minBytes = std::size_t(1) << 20) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        retention_ = retention;
+        release_ = release;
+        minBytes_.store(minBytes, std::memory_order_relaxed);
+        if (minBytes < LowestMinBytes()) {
+            lowestMinBytes_.store(minBytes, std::memory_order_relaxed);
+        }
+        Evict();
+    }
+    std::size_t Retention() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return retention_;
+    }
+    // no locking: read on every RawBuffer allocation
+    std::size_t MinBytes() const {
+        return minBytes_.load(std::memory_order_relaxed);
+    }
+    // smallest MinBytes() ever configured, no locking: smaller blocks were
+    // never allocated from the cache and need no Release() lookup
+    std::size_t LowestMinBytes() const {
+        return lowestMinBytes_.load(std::memory_order_relaxed);
+    }
+    // bytes held in free blocks
+    std::size_t Retained() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return retained_;
+    }
+    // page aligned or aligned to alignment if larger, nullptr on failure
+    void* Allocate(std::size_t size, std::size_t alignment) {
+        const std::size_t bytes = RoundUp(size, pageSize_);
+        std::lock_guard<std::mutex> lock(mutex_);
+        // best fit
+        std::size_t best = free_.size();
+        for (std::size_t i = 0; i != free_.size(); ++i) {
+            const Block& b = free_[i];
+            if (b.bytes >= bytes && b.bytes / 2 <= bytes &&
+                uintptr_t(b.data) % alignment == 0 &&
+                (best == free_.size() || b.bytes < free_[best].bytes)) {
+                best = i;
+            }
+        }
+        Block b;
+        if (best != free_.size()) {
+            b = free_[best];
+            free_.erase(free_.begin() + best);
+            retained_ -= b.bytes;
+        } else {
+            b.data = Map(bytes, alignment);
+            if (!b.data) return nullptr;
+            b.bytes = bytes;
+        }
+        used_[b.data] = b.bytes;
+        return b.data;
+    }
+    // false if p was not allocated from the cache
+    bool Release(void* p) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto i = used_.find(p);
+        if (i == used_.end()) return false;
+        const Block b{static_cast<char*>(p), i->second};
+        used_.erase(i);
+        if (b.bytes > retention_) {
+            munmap(b.data, b.bytes);
+            return true;
+        }
+        if (release_ == LargeBlockRelease::FREE) {
+#ifdef MADV_FREE
+            if (madvise(b.data, b.bytes, MADV_FREE))
+#endif
+                madvise(b.data, b.bytes, MADV_DONTNEED);
+        } else if (release_ == LargeBlockRelease::DONTNEED) {
+            madvise(b.data, b.bytes, MADV_DONTNEED);
+        }
+        free_.push_back(b);
+        retained_ += b.bytes;
+        Evict();
+        return true;
+    }
+    // unmap all free blocks
+    void Trim() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const Block& b : free_) munmap(b.data, b.bytes);
+        free_.clear();
+        retained_ = 0;
+    }
+
+   private:
+    struct Block {
+        char* data = nullptr;
+        std::size_t bytes = 0;
+    };
+    LargeBlockCache() : pageSize_(std::size_t(sysconf(_SC_PAGESIZE))) {}
+    static std::size_t RoundUp(std::size_t n, std::size_t a) {
+        return (n + a - 1) / a * a;
+    }
+    // map extra alignment bytes and unmap the misaligned head and the tail
+    char* Map(std::size_t bytes, std::size_t alignment) {
+        const std::size_t extra = alignment > pageSize_ ? alignment : 0;
+        void* m = mmap(nullptr, bytes + extra, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (m == MAP_FAILED) return nullptr;
+        char* p = static_cast<char*>(m);
+        if (!extra) return p;
+        char* aligned = p + (alignment - uintptr_t(p) % alignment) % alignment;
+        if (aligned != p) munmap(p, aligned - p);
+        const std::size_t tail = extra - (aligned - p);
+        if (tail) munmap(aligned + bytes, tail);
+        return aligned;
+    }
+    // oldest first
+    void Evict() {
+        std::size_t n = 0;
+        for (; n != free_.size() && retained_ > retention_; ++n) {
+            munmap(free_[n].data, free_[n].bytes);
+            retained_ -= free_[n].bytes;
+        }
+        free_.erase(free_.begin(), free_.begin() + n);
+    }
+
+   private:
+    mutable std::mutex mutex_;
+    const std::size_t pageSize_;
+    std::size_t retention_ = std::size_t(8) << 30;
+    std::atomic<std::size_t> minBytes_{std::size_t(1) << 20};
+    std::atomic<std::size_t> lowestMinBytes_{std::size_t(1) << 20};
+    LargeBlockRelease release_ = LargeBlockRelease::FREE;
+    std::size_t retained_ = 0;
+    std::vector<Block> free_;
+    std::unordered_map<void*, std::size_t> used_;
+};
@@ -0,0 +1,167 @@
+// Author: Ugo Varetto
+// Byte oriented LZ77 codec in the LZ4 family, no dependencies, for blocks of
+// up to 64 KiB (16 bit match offsets).
+// Stream of sequences:
+//   token: literal count (high 4 bits), match length - 4 (low 4 bits),
+//          a nibble of 15 continues with bytes added to it until one < 255
+//   literal bytes
+//   match offset, 2 bytes little endian (absent after the last literals)
+// Matches are found through a hash table of the last position of each
+// 4 byte sequence; the last 5 bytes are always literals.
+// LZCompress returns the compressed size, 0 if it exceeds the capacity of
+// the destination; LZDecompress returns false on malformed input or size
+// mismatch.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace lz_detail {
+constexpr int HASH_BITS = 14;
+constexpr std::size_t MIN_MATCH = 4;
+constexpr std::size_t LAST_LITERALS = 5;
+constexpr std::size_t MAX_OFFSET = 65535;
+
+inline uint32_t Load32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+inline uint64_t Load64(const uint8_t* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+inline uint32_t Hash(uint32_t v) {
+    return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// 15 in the token nibble, then bytes of 255 and the remainder
+inline bool PutLength(std::size_t n, uint8_t*& op, const uint8_t* end) {
+    for (; n >= 255; n -= 255) {
+        if (op == end) return false;
+        *op++ = 255;
+    }
+    if (op == end) return false;
+    *op++ = uint8_t(n);
+    return true;
+}
+
+inline bool GetLength(std::size_t& n, const uint8_t*& ip, const uint8_t* end) {
+    uint8_t b;
+    do {
+        if (ip == end) return false;
+        b = *ip++;
+        n += b;
+    } while (b == 255);
+    return true;
+}
+
+// literals [lit, lit + nlit), then match unless last
+inline bool PutSequence(const uint8_t* lit, std::size_t nlit,
+                        std::size_t offset, std::size_t len, bool last,
+                        uint8_t*& op, const uint8_t* end) {
+    if (op == end) return false;
+    const std::size_t m = last ? 0 : len - MIN_MATCH;
+    uint8_t* token = op++;
+    *token = uint8_t((nlit < 15 ? nlit : 15) << 4 | (m < 15 ? m : 15));
+    if (nlit >= 15 && !PutLength(nlit - 15, op, end)) return false;
+    if (std::size_t(end - op) < nlit) return false;
+    std::memcpy(op, lit, nlit);
+    op += nlit;
+    if (last) return true;
+    if (end - op < 2) return false;
+    *op++ = uint8_t(offset);
+    *op++ = uint8_t(offset >> 8);
+    return m < 15 || PutLength(m - 15, op, end);
+}
+}  // namespace lz_detail
+
+inline std::size_t LZCompress(const void* src, std::size_t n, void* dst,
+                              std::size_t capacity) {
+    using namespace lz_detail;
+    const uint8_t* in = static_cast<const uint8_t*>(src);
+    uint8_t* op = static_cast<uint8_t*>(dst);
+    const uint8_t* const end = op + capacity;
+    std::size_t ip = 0;
+    std::size_t anchor = 0;
+    if (n > LAST_LITERALS + MIN_MATCH) {
+        uint32_t table[1 << HASH_BITS] = {};
+        const std::size_t limit = n - LAST_LITERALS - MIN_MATCH;
+        // matches end before the last literals
+        const std::size_t matchEnd = n - LAST_LITERALS;
+        while (ip < limit) {
+            const uint32_t v = Load32(in + ip);
+            uint32_t& slot = table[Hash(v)];
+            const std::size_t cand = slot;
+            slot = uint32_t(ip);
+            if (cand >= ip || ip - cand > MAX_OFFSET ||
+                Load32(in + cand) != v) {
+                // skip faster through incompressible data
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+            std::size_t len = MIN_MATCH;
+            while (ip + len + 8 <= matchEnd) {
+                const uint64_t x =
+                    Load64(in + ip + len) ^ Load64(in + cand + len);
+                if (x) {
+                    len += __builtin_ctzll(x) / 8;
+                    goto found;
+                }
+                len += 8;
+            }
+            while (ip + len < matchEnd && in[ip + len] == in[cand + len]) ++len;
+        found:
+            if (!PutSequence(in + anchor, ip - anchor, ip - cand, len, false,
+                             op, end)) {
+                return 0;
+            }
+            ip += len;
+            anchor = ip;
+        }
+    }
+    if (!PutSequence(in + anchor, n - anchor, 0, 0, true, op, end)) return 0;
+    return std::size_t(op - static_cast<uint8_t*>(dst));
+}
+
+inline bool LZDecompress(const void* src, std::size_t n, void* dst,
+                         std::size_t size) {
+    using namespace lz_detail;
+    const uint8_t* ip = static_cast<const uint8_t*>(src);
+    const uint8_t* const iend = ip + n;
+    uint8_t* const out = static_cast<uint8_t*>(dst);
+    uint8_t* op = out;
+    uint8_t* const oend = out + size;
+    while (ip != iend) {
+        const uint8_t token = *ip++;
+        std::size_t nlit = token >> 4;
+        if (nlit == 15 && !GetLength(nlit, ip, iend)) return false;
+        if (std::size_t(iend - ip) < nlit || std::size_t(oend - op) < nlit) {
+            return false;
+        }
+        std::memcpy(op, ip, nlit);
+        ip += nlit;
+        op += nlit;
+        if (ip == iend) break;  // last literals
+        if (iend - ip < 2) return false;
+        const std::size_t offset = ip[0] | std::size_t(ip[1]) << 8;
+        ip += 2;
+        std::size_t len = token & 15;
+        if (len == 15 && !GetLength(len, ip, iend)) return false;
+        len += MIN_MATCH;
+        if (offset == 0 || offset > std::size_t(op - out) ||
+            len > std::size_t(oend - op)) {
+            return false;
+        }
+        // overlapping if offset < len: repeats the last offset bytes, copied
+        // offset bytes at a time
+        for (std::size_t c; len; len -= c, op += c) {
+            c = offset < len ? offset : len;
+            std::memcpy(op, op - offset, c);
+        }
+    }
+    return op == oend;
+}
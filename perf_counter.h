@@ -0,0 +1,77 @@
+// Author: Ugo Varetto
+// Hardware event counter for the calling thread through perf_event_open
+// (Linux only): Start() resets and enables, Stop() returns the count.
+// Valid() is false when counters are not available (other OS, virtual
+// machines, containers, kernel.perf_event_paranoid > 2), Stop() then
+// returns 0.
+
+#pragma once
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <cstdint>
+#include <cstring>
+
+enum class PerfEvent { CYCLES, INSTRUCTIONS, BRANCHES, BRANCH_MISSES };
+
+class PerfCounter {
+   public:
+    explicit PerfCounter(PerfEvent e) : fd_(-1) {
+#ifdef __linux__
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        switch (e) {
+            case PerfEvent::CYCLES:
+                attr.config = PERF_COUNT_HW_CPU_CYCLES;
+                break;
+            case PerfEvent::INSTRUCTIONS:
+                attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+                break;
+            case PerfEvent::BRANCHES:
+                attr.config = PERF_COUNT_HW_BRANCH_INSTRUCTIONS;
+                break;
+            case PerfEvent::BRANCH_MISSES:
+                attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+                break;
+        }
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+    PerfCounter(const PerfCounter&) = delete;
+    PerfCounter& operator=(const PerfCounter&) = delete;
+    ~PerfCounter() {
+#ifdef __linux__
+        if (fd_ >= 0) close(fd_);
+#endif
+    }
+    bool Valid() const { return fd_ >= 0; }
+    void Start() {
+#ifdef __linux__
+        if (fd_ < 0) return;
+        ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+    uint64_t Stop() {
+        uint64_t count = 0;
+#ifdef __linux__
+        if (fd_ < 0) return 0;
+        ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd_, &count, sizeof(count)) != sizeof(count)) count = 0;
+#endif
+        return count;
+    }
+
+   private:
+    int fd_;
+};
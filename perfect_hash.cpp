@@ -0,0 +1,134 @@
+//
+// Compile time perfect hash lookup vs if/strcmp chains and
+// unordered_map<string, int> for 10 to 1000 keys
+// Usage: perfect_hash [num lookups, default 2^20]
+// Author: Ugo Varetto
+//
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "perfect_hash.h"
+
+using namespace std;
+
+using Clock = chrono::high_resolution_clock;
+template <typename TimeDiffNsT>
+constexpr double NsToSec(const TimeDiffNsT& diff) {
+    return double(chrono::duration_cast<chrono::nanoseconds>(diff).count()) /
+           1E9;
+}
+
+//------------------------------------------------------------------------------
+constexpr char GET[] = "get";
+constexpr char PUT[] = "put";
+constexpr char DELETE[] = "delete";
+constexpr auto VERBS = MakePerfectHash<Str<GET>, Str<PUT>, Str<DELETE>>();
+static_assert(VERBS.Find("put") == 1 && VERBS.Find("delete") == 2);
+static_assert(VERBS.Find("post") == -1 && VERBS.Find("") == -1);
+
+//------------------------------------------------------------------------------
+// Command like keys: 3 to 10 random letters, '_', base 26 index
+using Name = array<char, 16>;
+
+template <size_t N>
+constexpr array<Name, N> MakeNames() {
+    array<Name, N> names{};
+    uint64_t x = 12345;
+    for (size_t i = 0; i != N; ++i) {
+        x = x * 6364136223846793005ull + 1442695040888963407ull;
+        const size_t len = 3 + (x >> 60) % 8;
+        size_t c = 0;
+        for (; c != len; ++c) names[i][c] = char('a' + (x >> (5 * c)) % 26);
+        names[i][c++] = '_';
+        for (size_t j = i; j || c == len + 1; j /= 26)
+            names[i][c++] = char('a' + j % 26);
+    }
+    return names;
+}
+
+template <size_t N>
+struct Keys {
+    static constexpr array<Name, N> NAMES = MakeNames<N>();
+    static constexpr array<string_view, N> VIEWS = [] {
+        array<string_view, N> v{};
+        for (size_t i = 0; i != N; ++i) v[i] = string_view(NAMES[i].data());
+        return v;
+    }();
+    static constexpr PerfectHash<N> TABLE{VIEWS};
+};
+
+static_assert(Keys<1000>::TABLE.Find(Keys<1000>::VIEWS[999]) == 999);
+
+// if (!strcmp(s, key0)) ... else if (!strcmp(s, key1)) ...
+template <size_t N, size_t... I>
+int StrcmpChain(const char* s, index_sequence<I...>) {
+    int r = -1;
+    (void)(... ||
+           (!strcmp(s, Keys<N>::NAMES[I].data()) ? (r = int(I), true)
+                                                 : false));
+    return r;
+}
+
+template <typename F>
+double Time(const vector<string>& queries, int64_t& check, F f) {
+    check = 0;
+    const auto start = Clock::now();
+    for (const string& q : queries) check += f(q);
+    return 1E9 * NsToSec(Clock::now() - start) / queries.size();
+}
+
+template <size_t N>
+bool Bench(size_t lookups) {
+    using K = Keys<N>;
+    // 90% hits
+    mt19937 gen(N);
+    vector<string> queries(lookups);
+    for (auto& q : queries) {
+        q = K::VIEWS[gen() % N];
+        if (gen() % 10 == 0) q.back() = '#';
+    }
+    unordered_map<string, int> map;
+    for (size_t i = 0; i != N; ++i) map[string(K::VIEWS[i])] = int(i);
+    int64_t c[3];
+    const double tchain = Time(queries, c[0], [](const string& q) {
+        return StrcmpChain<N>(q.c_str(), make_index_sequence<N>());
+    });
+    const double tmap = Time(queries, c[1], [&](const string& q) {
+        const auto i = map.find(q);
+        return i == map.end() ? -1 : i->second;
+    });
+    const double thash = Time(queries, c[2], [](const string& q) {
+        return K::TABLE.Find(q);
+    });
+    cout << setw(6) << N << setw(14) << tchain << setw(16) << tmap
+         << setw(14) << thash << setw(10)
+         << (K::TABLE.SLOTS * 4 + K::TABLE.BUCKETS * 4) / 1024.0 << endl;
+    return c[0] == c[1] && c[1] == c[2];
+}
+
+template <size_t... N>
+bool BenchAll(size_t lookups) {
+    return (... & Bench<N>(lookups));
+}
+
+//------------------------------------------------------------------------------
+int main(int argc, char const* argv[]) {
+    const size_t lookups = argc > 1 ? stoull(argv[1]) : size_t(1) << 20;
+    cout << setprecision(3) << "ns/lookup, 90% hits" << endl
+         << "  keys  strcmp chain  unordered_map  perfect hash  table KiB"
+         << endl;
+    const bool ok = BenchAll<10, 30, 100, 300, 1000>(lookups);
+    cout << (ok ? "results match" : "ERROR: results differ") << endl;
+    return ok ? 0 : 1;
+}
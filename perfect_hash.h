@@ -0,0 +1,188 @@
+// Author: Ugo Varetto
+// Compile time perfect hash over a fixed set of string keys (hash and
+// displace): keys are split into buckets by hash, each bucket gets the
+// smallest displacement that moves all of its keys to free slots. The
+// table is built by the compiler; a lookup is one string hash, two table
+// reads and one string compare.
+//   constexpr char GET[] = "get";
+//   constexpr char PUT[] = "put";
+//   constexpr auto ROUTER = MakePerfectHash<Str<GET>, Str<PUT>>();
+//   ROUTER.Find("put") == 1; ROUTER.Find("del") == -1
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+// Compile time string key
+template <const char* C>
+struct Str {
+    static constexpr const char* value = C;
+};
+
+namespace perfect_hash_detail {
+// BYTES little endian bytes at s[i], one load at run time
+template <int BYTES>
+constexpr uint64_t Load(std::string_view s, std::size_t i) {
+    if (std::is_constant_evaluated()) {
+        uint64_t w = 0;
+        for (int k = 0; k != BYTES; ++k)
+            w |= uint64_t(uint8_t(s[i + k])) << (8 * k);
+        return w;
+    } else {
+        using W = std::conditional_t<BYTES == 8, uint64_t,
+                                     std::conditional_t<BYTES == 4, uint32_t,
+                                                        uint8_t>>;
+        W w;
+        std::memcpy(&w, s.data() + i, BYTES);
+        return w;
+    }
+}
+
+// murmur3 finalizer
+constexpr uint64_t Mix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDull;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+// Tail loads overlap instead of looping over the last bytes: no data
+// dependent loop for short keys
+constexpr uint64_t Hash(std::string_view s) {
+    constexpr uint64_t K = 0x9E3779B97F4A7C15ull;
+    const std::size_t n = s.size();
+    uint64_t h = K ^ n;
+    if (n >= 8) {
+        for (std::size_t i = 0; i + 8 < n; i += 8) h = (h ^ Load<8>(s, i)) * K;
+        h = (h ^ Load<8>(s, n - 8)) * K;
+    } else if (n >= 4) {
+        h = (h ^ (Load<4>(s, 0) << 32 | Load<4>(s, n - 4))) * K;
+    } else if (n > 0) {
+        h = (h ^ (Load<1>(s, 0) << 16 | Load<1>(s, n / 2) << 8 |
+                  Load<1>(s, n - 1))) *
+            K;
+    }
+    return Mix(h);
+}
+}  // namespace perfect_hash_detail
+
+//------------------------------------------------------------------------------
+template <std::size_t N>
+class PerfectHash {
+   public:
+    // slots: power of two, load factor <= 3/4
+    static constexpr std::size_t SLOTS =
+        std::bit_ceil(N) * (4 * N > 3 * std::bit_ceil(N) ? 2 : 1);
+    // ~2 keys per bucket
+    static constexpr std::size_t BUCKETS = std::bit_ceil((N + 1) / 2);
+
+    // Throws (not a constant expression at compile time) on duplicate keys
+    constexpr explicit PerfectHash(const std::array<std::string_view, N>& keys)
+        : keys_(keys), displacement_{}, slots_{} {
+        using namespace perfect_hash_detail;
+        std::array<uint64_t, N> hashes{};
+        // keys sorted by bucket: bucket b is order[first[b], first[b + 1])
+        std::array<std::size_t, BUCKETS + 1> first{};
+        std::array<int32_t, N> order{};
+        for (std::size_t i = 0; i != N; ++i) {
+            hashes[i] = Hash(keys[i]);
+            ++first[Bucket(hashes[i]) + 1];
+        }
+        std::size_t maxSize = 0;
+        for (std::size_t b = 0; b != BUCKETS; ++b) {
+            if (first[b + 1] > maxSize) maxSize = first[b + 1];
+            first[b + 1] += first[b];
+        }
+        std::array<std::size_t, BUCKETS> fill{};
+        for (std::size_t i = 0; i != N; ++i) {
+            const std::size_t b = Bucket(hashes[i]);
+            order[first[b] + fill[b]++] = int32_t(i);
+        }
+        for (auto& s : slots_) s = -1;
+        // largest buckets first, while most slots are free
+        for (std::size_t size = maxSize; size > 0; --size) {
+            for (std::size_t b = 0; b != BUCKETS; ++b) {
+                if (first[b + 1] - first[b] != size) continue;
+                displacement_[b] = Place(hashes, order, first[b], size);
+            }
+        }
+    }
+
+    // Index of s in the key list, -1 if not a key
+    constexpr int Find(std::string_view s) const {
+        const uint64_t h = perfect_hash_detail::Hash(s);
+        const int32_t i = slots_[Slot(h, displacement_[Bucket(h)])];
+        return i >= 0 && keys_[i] == s ? i : -1;
+    }
+
+    // Calls handlers[i](args...) for key i, false if s is not a key
+    template <typename HandlersT, typename... ArgsT>
+    bool Call(std::string_view s, const HandlersT& handlers,
+              ArgsT&&... args) const {
+        const int i = Find(s);
+        if (i < 0) return false;
+        handlers[i](std::forward<ArgsT>(args)...);
+        return true;
+    }
+
+    constexpr std::size_t Size() const { return N; }
+    constexpr std::string_view Key(std::size_t i) const { return keys_[i]; }
+
+   private:
+    static constexpr std::size_t Bucket(uint64_t h) {
+        return std::size_t(h >> 32) & (BUCKETS - 1);
+    }
+    static constexpr std::size_t Slot(uint64_t h, uint32_t d) {
+        return std::size_t(perfect_hash_detail::Mix(
+                   h ^ (uint64_t(d) * 0x9E3779B97F4A7C15ull))) &
+               (SLOTS - 1);
+    }
+    // First displacement mapping all keys of the bucket to distinct free
+    // slots, slots are then taken
+    constexpr uint32_t Place(const std::array<uint64_t, N>& hashes,
+                             const std::array<int32_t, N>& order,
+                             std::size_t begin, std::size_t size) {
+        // identical hashes never separate: duplicate key
+        for (std::size_t j = 0; j != size; ++j) {
+            for (std::size_t l = j + 1; l != size; ++l) {
+                if (hashes[order[begin + j]] == hashes[order[begin + l]])
+                    throw std::logic_error("duplicate or colliding keys");
+            }
+        }
+        for (uint32_t d = 0; d != (uint32_t(1) << 20); ++d) {
+            std::size_t k = 0;
+            for (; k != size; ++k) {
+                const std::size_t s = Slot(hashes[order[begin + k]], d);
+                if (slots_[s] >= 0) break;
+                slots_[s] = order[begin + k];
+            }
+            if (k == size) return d;
+            // undo
+            for (std::size_t j = 0; j != k; ++j)
+                slots_[Slot(hashes[order[begin + j]], d)] = -1;
+        }
+        throw std::logic_error("no displacement found");
+    }
+
+    std::array<std::string_view, N> keys_;
+    std::array<uint32_t, BUCKETS> displacement_;
+    std::array<int32_t, SLOTS> slots_;
+};
+
+// From a list of Str<...> keys, key i has index i
+template <typename... KeysT>
+constexpr PerfectHash<sizeof...(KeysT)> MakePerfectHash() {
+    return PerfectHash<sizeof...(KeysT)>(
+        std::array<std::string_view, sizeof...(KeysT)>{
+            std::string_view(KeysT::value)...});
+}
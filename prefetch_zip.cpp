@@ -0,0 +1,97 @@
+//
+// Gather heavy join through Zip: rows of (key, quantity) probe a dimension
+// table of 64 byte records much larger than the caches, summing
+// price * quantity; plain Zip vs Prefetch (direct) and PrefetchIndirect on
+// the key column (indices into the table) or on a pointer column, at
+// several prefetch distances, ns per row
+// Usage: prefetch_zip [table size in MiB, default 512]
+//                     [rows, default 2^24]
+// Author: Ugo Varetto
+//
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "zip.h"
+
+using namespace std;
+
+using Clock = chrono::high_resolution_clock;
+template <typename TimeDiffNsT>
+constexpr double NsToSec(const TimeDiffNsT& diff) {
+    return double(chrono::duration_cast<chrono::nanoseconds>(diff).count()) /
+           1E9;
+}
+
+//------------------------------------------------------------------------------
+struct Record {
+    uint64_t price;
+    char payload[56];
+};
+
+// ns per row
+template <typename ZipT, typename F>
+double Join(ZipT zip, size_t rows, uint64_t& sum, F rowValue) {
+    sum = 0;
+    const auto start = Clock::now();
+    for (auto t : zip) sum += rowValue(t);
+    return 1E9 * NsToSec(Clock::now() - start) / rows;
+}
+
+template <int D>
+bool Distance(const vector<Record>& table, vector<uint32_t>& keys,
+              vector<uint32_t>& qty, vector<const Record*>& ptrs,
+              uint64_t expected) {
+    const auto byKey = [&](auto t) {
+        return table[get<0>(t)].price * get<1>(t);
+    };
+    const auto byPtr = [](auto t) { return get<0>(t)->price * get<1>(t); };
+    uint64_t s[3];
+    const double direct =
+        Join(Prefetch<D>(Zip(keys, qty)), keys.size(), s[0], byKey);
+    const double index = Join(PrefetchIndirect<D, 0>(Zip(keys, qty), table),
+                              keys.size(), s[1], byKey);
+    const double pointer = Join(PrefetchIndirect<D, 0>(Zip(ptrs, qty)),
+                                keys.size(), s[2], byPtr);
+    cout << setw(10) << D << setw(10) << direct << setw(10) << index
+         << setw(10) << pointer << endl;
+    return s[0] == expected && s[1] == expected && s[2] == expected;
+}
+
+//------------------------------------------------------------------------------
+int main(int argc, char const* argv[]) {
+    const size_t tableSize =
+        (argc > 1 ? stoull(argv[1]) : 512) * (1 << 20) / sizeof(Record);
+    const size_t rows = argc > 2 ? stoull(argv[2]) : size_t(1) << 24;
+    vector<Record> table(tableSize);
+    for (size_t i = 0; i != table.size(); ++i) table[i].price = i % 1000;
+    mt19937 gen(1);
+    vector<uint32_t> keys(rows);
+    vector<uint32_t> qty(rows);
+    vector<const Record*> ptrs(rows);
+    for (size_t i = 0; i != rows; ++i) {
+        keys[i] = uint32_t(gen() % tableSize);
+        qty[i] = gen() % 100;
+        ptrs[i] = &table[keys[i]];
+    }
+    uint64_t expected;
+    const double plain =
+        Join(Zip(keys, qty), rows, expected,
+             [&](auto t) { return table[get<0>(t)].price * get<1>(t); });
+    cout << setprecision(3) << "ns/row, " << rows << " rows, "
+         << (tableSize * sizeof(Record) >> 20) << " MiB table" << endl
+         << "plain Zip: " << plain << endl
+         << "  distance    direct     index   pointer" << endl;
+    bool ok = Distance<4>(table, keys, qty, ptrs, expected);
+    ok = Distance<8>(table, keys, qty, ptrs, expected) && ok;
+    ok = Distance<16>(table, keys, qty, ptrs, expected) && ok;
+    ok = Distance<32>(table, keys, qty, ptrs, expected) && ok;
+    ok = Distance<64>(table, keys, qty, ptrs, expected) && ok;
+    cout << (ok ? "results match" : "ERROR: results differ") << endl;
+    return ok ? 0 : 1;
+}
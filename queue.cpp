@@ -0,0 +1,262 @@
+//
+// Moving data between threads: mutex and condition variable queue vs lock
+// free SPSC and MPMC queues, single element and batched (32) operations.
+// - throughput: P producers and P consumers, 1 to N each
+// - latency: round trip of a value between two threads through two queues
+// Lock free queues spin, yielding the thread, when full or empty.
+// Usage: queue [max producers, default hardware concurrency / 2]
+//              [total items, default 2^20]
+// Author: Ugo Varetto
+//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "queue.h"
+#include "raw_buffer.h"
+
+using namespace std;
+
+using Clock = chrono::high_resolution_clock;
+template <typename TimeDiffNsT>
+constexpr double NsToSec(const TimeDiffNsT& diff) {
+    return double(chrono::duration_cast<chrono::nanoseconds>(diff).count()) /
+           1E9;
+}
+
+//------------------------------------------------------------------------------
+// Bounded blocking queue
+template <typename T>
+class MutexQueue {
+   public:
+    explicit MutexQueue(size_t capacity) : capacity_(capacity) {}
+    void Push(T v) {
+        unique_lock<mutex> lock(mutex_);
+        notFull_.wait(lock, [this] { return queue_.size() < capacity_; });
+        queue_.push_back(move(v));
+        notEmpty_.notify_one();
+    }
+    T Pop() {
+        unique_lock<mutex> lock(mutex_);
+        notEmpty_.wait(lock, [this] { return !queue_.empty(); });
+        T v = move(queue_.front());
+        queue_.pop_front();
+        notFull_.notify_one();
+        return v;
+    }
+
+   private:
+    const size_t capacity_;
+    mutex mutex_;
+    condition_variable notFull_;
+    condition_variable notEmpty_;
+    deque<T> queue_;
+};
+
+// Blocking operations on top of non blocking ones
+template <typename Q>
+void SpinPush(Q& q, uint64_t v) {
+    while (!q.TryPush(v)) this_thread::yield();
+}
+
+template <typename Q>
+uint64_t SpinPop(Q& q) {
+    for (;;) {
+        if (auto v = q.TryPop()) return *v;
+        this_thread::yield();
+    }
+}
+
+constexpr size_t CAPACITY = 1024;
+constexpr size_t BATCH = 32;
+
+// Mitems/s; producer p pushes p, p + P, p + 2P...; check: sum of popped
+// values
+template <typename ProduceF, typename ConsumeF>
+double Throughput(int producers, size_t total, uint64_t& check,
+                  ProduceF produce, ConsumeF consume) {
+    atomic<uint64_t> sum{0};
+    atomic<size_t> tickets{0};
+    vector<thread> threads;
+    const auto start = Clock::now();
+    for (int p = 0; p != producers; ++p) {
+        threads.emplace_back([&, p] { produce(p, producers, total); });
+    }
+    for (int c = 0; c != producers; ++c) {
+        threads.emplace_back([&] { sum += consume(tickets, total); });
+    }
+    for (auto& t : threads) t.join();
+    check = sum;
+    return total / NsToSec(Clock::now() - start) / 1E6;
+}
+
+// producer loop, one element at a time
+template <typename PushF>
+void PushEach(int p, int producers, size_t total, PushF push) {
+    for (size_t i = p; i < total; i += producers) push(uint64_t(i));
+}
+
+// consumer loop: one ticket per element, claimed before popping
+template <typename Q, typename PopF>
+uint64_t PopTickets(Q& q, atomic<size_t>& tickets, size_t total, PopF pop) {
+    uint64_t s = 0;
+    while (tickets.fetch_add(1) < total) s += pop(q);
+    return s;
+}
+
+// consumer loop, batched: pop until all elements are counted
+template <typename Q>
+uint64_t PopBatches(Q& q, atomic<size_t>& popped, size_t total) {
+    uint64_t s = 0;
+    while (popped.load(memory_order_relaxed) < total) {
+        const size_t n = q.TryPopBatch(BATCH, [&s](uint64_t v) { s += v; });
+        if (n) {
+            popped += n;
+        } else {
+            this_thread::yield();
+        }
+    }
+    return s;
+}
+
+template <typename Q>
+void PushBatches(Q& q, int p, int producers, size_t total) {
+    uint64_t batch[BATCH];
+    size_t i = p;
+    while (i < total) {
+        size_t n = 0;
+        for (; n != BATCH && i < total; ++n, i += producers) batch[n] = i;
+        for (size_t pushed = 0; pushed != n;) {
+            const size_t k = q.TryPushBatch(batch + pushed, batch + n);
+            if (!k) this_thread::yield();
+            pushed += k;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// ns per round trip
+template <typename PushF, typename PopF>
+double Latency(size_t trips, PushF push, PopF pop) {
+    const auto start = Clock::now();
+    thread echo([&] {
+        for (size_t i = 0; i != trips; ++i) push(1, pop(0));
+    });
+    for (size_t i = 0; i != trips; ++i) {
+        push(0, i);
+        if (pop(1) != i) cerr << "ERROR: wrong value" << endl;
+    }
+    echo.join();
+    return 1E9 * NsToSec(Clock::now() - start) / trips;
+}
+
+//------------------------------------------------------------------------------
+int main(int argc, char const* argv[]) {
+    const int maxProducers =
+        argc > 1 ? stoi(argv[1])
+                 : max(1, int(thread::hardware_concurrency()) / 2);
+    const size_t total = argc > 2 ? stoull(argv[2]) : size_t(1) << 20;
+    // move-only elements
+    SPSCQueue<RawBuffer> sb(4);
+    MPMCQueue<RawBuffer> mb(4);
+    sb.TryPush(RawBuffer(1000));
+    mb.TryPush(RawBuffer(2000));
+    auto b1 = sb.TryPop();
+    auto b2 = mb.TryPop();
+    if (!b1 || !b2 || b1->Size() != 1000 || b2->Size() != 2000 ||
+        sb.TryPop() || mb.TryPop()) {
+        cerr << "ERROR: wrong queue content" << endl;
+        return 1;
+    }
+    const uint64_t expected = uint64_t(total) * (total - 1) / 2;
+    bool ok = true;
+    cout << setprecision(3) << "throughput, Mitems/s" << endl
+         << "producers/consumers   mutex    spsc    mpmc  mpmc batch  "
+            "spsc batch"
+         << endl;
+    for (int p = 1; p <= maxProducers; p *= 2) {
+        uint64_t c[5];
+        MutexQueue<uint64_t> mq(CAPACITY);
+        const double tm = Throughput(
+            p, total, c[0],
+            [&](int i, int n, size_t t) {
+                PushEach(i, n, t, [&](uint64_t v) { mq.Push(v); });
+            },
+            [&](atomic<size_t>& t, size_t n) {
+                return PopTickets(mq, t, n, [](auto& q) { return q.Pop(); });
+            });
+        MPMCQueue<uint64_t> q(CAPACITY);
+        const double tq = Throughput(
+            p, total, c[1],
+            [&](int i, int n, size_t t) {
+                PushEach(i, n, t, [&](uint64_t v) { SpinPush(q, v); });
+            },
+            [&](atomic<size_t>& t, size_t n) {
+                return PopTickets(q, t, n,
+                                  [](auto& q) { return SpinPop(q); });
+            });
+        const double tqb = Throughput(
+            p, total, c[2],
+            [&](int i, int n, size_t t) { PushBatches(q, i, n, t); },
+            [&](atomic<size_t>& t, size_t n) { return PopBatches(q, t, n); });
+        cout << setw(19) << p << setw(8) << tm;
+        ok = ok && c[0] == expected && c[1] == expected && c[2] == expected;
+        if (p == 1) {
+            SPSCQueue<uint64_t> s(CAPACITY);
+            const double ts = Throughput(
+                1, total, c[3],
+                [&](int i, int n, size_t t) {
+                    PushEach(i, n, t, [&](uint64_t v) { SpinPush(s, v); });
+                },
+                [&](atomic<size_t>& t, size_t n) {
+                    return PopTickets(s, t, n,
+                                      [](auto& q) { return SpinPop(q); });
+                });
+            const double tsb = Throughput(
+                1, total, c[4],
+                [&](int i, int n, size_t t) { PushBatches(s, i, n, t); },
+                [&](atomic<size_t>& t, size_t n) {
+                    return PopBatches(s, t, n);
+                });
+            ok = ok && c[3] == expected && c[4] == expected;
+            cout << setw(8) << ts << setw(8) << tq << setw(12) << tqb
+                 << setw(12) << tsb << endl;
+        } else {
+            cout << setw(8) << '-' << setw(8) << tq << setw(12) << tqb
+                 << setw(12) << '-' << endl;
+        }
+        if (p < maxProducers && 2 * p > maxProducers) p = maxProducers / 2;
+    }
+    // latency
+    const size_t trips = max(total / 16, size_t(1));
+    MutexQueue<uint64_t> mq0(CAPACITY), mq1(CAPACITY);
+    MutexQueue<uint64_t>* mq[2] = {&mq0, &mq1};
+    const double lm = Latency(
+        trips, [&](int i, uint64_t v) { mq[i]->Push(v); },
+        [&](int i) { return mq[i]->Pop(); });
+    SPSCQueue<uint64_t> sq0(CAPACITY), sq1(CAPACITY);
+    SPSCQueue<uint64_t>* sq[2] = {&sq0, &sq1};
+    const double ls = Latency(
+        trips, [&](int i, uint64_t v) { SpinPush(*sq[i], v); },
+        [&](int i) { return SpinPop(*sq[i]); });
+    MPMCQueue<uint64_t> pq0(CAPACITY), pq1(CAPACITY);
+    MPMCQueue<uint64_t>* pq[2] = {&pq0, &pq1};
+    const double lp = Latency(
+        trips, [&](int i, uint64_t v) { SpinPush(*pq[i], v); },
+        [&](int i) { return SpinPop(*pq[i]); });
+    cout << "round trip latency, ns" << endl
+         << "     mutex      spsc      mpmc" << endl
+         << setw(10) << lm << setw(10) << ls << setw(10) << lp << endl;
+    cout << (ok ? "results match" : "ERROR: results differ") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,254 @@
+// Author: Ugo Varetto
+// Bounded lock free queues, capacity rounded up to a power of two:
+// - SPSCQueue: one producer and one consumer thread; each side owns its
+//   index and keeps a cached copy of the other one, reloaded only when the
+//   queue looks full (producer) or empty (consumer)
+// - MPMCQueue: any number of producers and consumers (Vyukov): each cell
+//   carries a sequence number telling whether it is ready to be written or
+//   read at a given position, threads claim positions with a compare and
+//   swap on the shared index
+// Indices live on separate cache lines. Elements are moved in and out and
+// only need to be move constructible, move-only types like RawBuffer work.
+// Batched operations move up to n elements with a single index update.
+// All operations are non blocking and return false/empty/0 when the queue
+// is full or empty.
+//   SPSCQueue<RawBuffer> q(1024);
+//   q.TryPush(std::move(buffer));           // producer
+//   if (auto b = q.TryPop()) Process(*b);   // consumer
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <optional>
+#include <utility>
+
+namespace queue_detail {
+constexpr std::size_t CACHE_LINE = 64;
+
+inline std::size_t RoundUpPow2(std::size_t n) {
+    std::size_t p = 1;
+    while (p < n) p *= 2;
+    return p;
+}
+
+// uninitialized storage for one T
+template <typename T>
+struct Storage {
+    alignas(T) unsigned char bytes[sizeof(T)];
+    T* Get() { return std::launder(reinterpret_cast<T*>(bytes)); }
+    template <typename... Args>
+    void Construct(Args&&... args) {
+        new (bytes) T(std::forward<Args>(args)...);
+    }
+    // move out and destroy
+    T Take() {
+        T v(std::move(*Get()));
+        Get()->~T();
+        return v;
+    }
+};
+}  // namespace queue_detail
+
+//------------------------------------------------------------------------------
+template <typename T>
+class SPSCQueue {
+   public:
+    explicit SPSCQueue(std::size_t capacity)
+        : mask_(queue_detail::RoundUpPow2(capacity) - 1),
+          slots_(new queue_detail::Storage<T>[mask_ + 1]) {}
+    SPSCQueue(const SPSCQueue&) = delete;
+    SPSCQueue& operator=(const SPSCQueue&) = delete;
+    ~SPSCQueue() {
+        while (TryPop()) {
+        }
+    }
+    std::size_t Capacity() const { return mask_ + 1; }
+
+    template <typename... Args>
+    bool TryEmplace(Args&&... args) {
+        const std::size_t w = write_.load(std::memory_order_relaxed);
+        if (w - readCache_ == Capacity()) {
+            readCache_ = read_.load(std::memory_order_acquire);
+            if (w - readCache_ == Capacity()) return false;
+        }
+        slots_[w & mask_].Construct(std::forward<Args>(args)...);
+        write_.store(w + 1, std::memory_order_release);
+        return true;
+    }
+    bool TryPush(T&& v) { return TryEmplace(std::move(v)); }
+    bool TryPush(const T& v) { return TryEmplace(v); }
+
+    std::optional<T> TryPop() {
+        const std::size_t r = read_.load(std::memory_order_relaxed);
+        if (r == writeCache_) {
+            writeCache_ = write_.load(std::memory_order_acquire);
+            if (r == writeCache_) return std::nullopt;
+        }
+        std::optional<T> v(slots_[r & mask_].Take());
+        read_.store(r + 1, std::memory_order_release);
+        return v;
+    }
+
+    // moves elements from [first, last) until full, returns the number moved
+    template <typename It>
+    std::size_t TryPushBatch(It first, It last) {
+        const std::size_t w = write_.load(std::memory_order_relaxed);
+        std::size_t n = std::size_t(std::distance(first, last));
+        if (Capacity() - (w - readCache_) < n) {
+            readCache_ = read_.load(std::memory_order_acquire);
+        }
+        n = std::min(n, Capacity() - (w - readCache_));
+        for (std::size_t i = 0; i != n; ++i, ++first) {
+            slots_[(w + i) & mask_].Construct(std::move(*first));
+        }
+        write_.store(w + n, std::memory_order_release);
+        return n;
+    }
+
+    // calls f(T&&) on up to max elements, returns the number popped
+    template <typename F>
+    std::size_t TryPopBatch(std::size_t max, F&& f) {
+        const std::size_t r = read_.load(std::memory_order_relaxed);
+        if (writeCache_ - r < max) {
+            writeCache_ = write_.load(std::memory_order_acquire);
+        }
+        const std::size_t n = std::min(max, writeCache_ - r);
+        for (std::size_t i = 0; i != n; ++i) {
+            f(slots_[(r + i) & mask_].Take());
+        }
+        read_.store(r + n, std::memory_order_release);
+        return n;
+    }
+
+   private:
+    const std::size_t mask_;
+    std::unique_ptr<queue_detail::Storage<T>[]> slots_;
+    // producer line
+    alignas(queue_detail::CACHE_LINE) std::atomic<std::size_t> write_{0};
+    std::size_t readCache_ = 0;
+    // consumer line
+    alignas(queue_detail::CACHE_LINE) std::atomic<std::size_t> read_{0};
+    std::size_t writeCache_ = 0;
+    char pad_[queue_detail::CACHE_LINE - 2 * sizeof(std::size_t)];
+};
+
+//------------------------------------------------------------------------------
+template <typename T>
+class MPMCQueue {
+   public:
+    explicit MPMCQueue(std::size_t capacity)
+        : mask_(queue_detail::RoundUpPow2(capacity) - 1),
+          cells_(new Cell[mask_ + 1]) {
+        // cell i is ready to be written at position i
+        for (std::size_t i = 0; i <= mask_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    MPMCQueue(const MPMCQueue&) = delete;
+    MPMCQueue& operator=(const MPMCQueue&) = delete;
+    ~MPMCQueue() {
+        while (TryPop()) {
+        }
+    }
+    std::size_t Capacity() const { return mask_ + 1; }
+
+    template <typename... Args>
+    bool TryEmplace(Args&&... args) {
+        std::size_t pos;
+        if (!Claim(write_, 1, 0, pos)) return false;
+        Cell& cell = cells_[pos & mask_];
+        cell.value.Construct(std::forward<Args>(args)...);
+        cell.sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+    bool TryPush(T&& v) { return TryEmplace(std::move(v)); }
+    bool TryPush(const T& v) { return TryEmplace(v); }
+
+    std::optional<T> TryPop() {
+        std::size_t pos;
+        if (!Claim(read_, 1, 1, pos)) return std::nullopt;
+        Cell& cell = cells_[pos & mask_];
+        std::optional<T> v(cell.value.Take());
+        // ready to be written one lap later
+        cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return v;
+    }
+
+    // moves elements from [first, last) until full, returns the number moved
+    template <typename It>
+    std::size_t TryPushBatch(It first, It last) {
+        std::size_t pos;
+        const std::size_t n =
+            Claim(write_, std::size_t(std::distance(first, last)), 0, pos);
+        for (std::size_t i = 0; i != n; ++i, ++first) {
+            Cell& cell = cells_[(pos + i) & mask_];
+            cell.value.Construct(std::move(*first));
+            cell.sequence.store(pos + i + 1, std::memory_order_release);
+        }
+        return n;
+    }
+
+    // calls f(T&&) on up to max elements, returns the number popped
+    template <typename F>
+    std::size_t TryPopBatch(std::size_t max, F&& f) {
+        std::size_t pos;
+        const std::size_t n = Claim(read_, max, 1, pos);
+        for (std::size_t i = 0; i != n; ++i) {
+            Cell& cell = cells_[(pos + i) & mask_];
+            f(cell.value.Take());
+            cell.sequence.store(pos + i + mask_ + 1,
+                                std::memory_order_release);
+        }
+        return n;
+    }
+
+   private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        queue_detail::Storage<T> value;
+    };
+    // claims up to max consecutive positions from the current value of index
+    // whose cells are ready, sequence == position + offset (0: ready for
+    // writing, 1: ready for reading), with one compare and swap; returns
+    // the number of positions claimed, pos the first one
+    std::size_t Claim(std::atomic<std::size_t>& index, std::size_t max,
+                      std::size_t offset, std::size_t& pos) {
+        pos = index.load(std::memory_order_relaxed);
+        if (!max) return 0;
+        for (;;) {
+            const std::ptrdiff_t diff = std::ptrdiff_t(
+                Sequence(pos) - (pos + offset));
+            // lap behind: full when writing, empty when reading
+            if (diff < 0) return 0;
+            // another thread claimed pos
+            if (diff > 0) {
+                pos = index.load(std::memory_order_relaxed);
+                continue;
+            }
+            std::size_t n = 1;
+            while (n != max && n != Capacity() &&
+                   Sequence(pos + n) == pos + n + offset) {
+                ++n;
+            }
+            if (index.compare_exchange_weak(pos, pos + n,
+                                            std::memory_order_relaxed)) {
+                return n;
+            }
+        }
+    }
+    std::size_t Sequence(std::size_t pos) const {
+        return cells_[pos & mask_].sequence.load(std::memory_order_acquire);
+    }
+
+   private:
+    const std::size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(queue_detail::CACHE_LINE) std::atomic<std::size_t> write_{0};
+    alignas(queue_detail::CACHE_LINE) std::atomic<std::size_t> read_{0};
+    char pad_[queue_detail::CACHE_LINE - sizeof(std::size_t)];
+};
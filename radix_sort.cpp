@@ -0,0 +1,270 @@
+//
+// LSD radix sort for floating point (and integer) keys, optionally carrying
+// a payload: RadixSort(Zip(keys, values));
+// Floats are mapped to unsigned integers with the same ordering:
+// positive: flip sign bit, negative: flip all bits, resulting order is
+// -NaN < -inf < ... < -0 < +0 < ... < +inf < +NaN.
+// Usage: radix_sort [max elements, default 2^24] [threads]
+// Author: Ugo Varetto
+//
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "float_bits.h"
+#include "zip.h"
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+// Order preserving key <--> unsigned integer transforms
+template <typename T, typename Enable = void>
+struct RadixTraits {};
+
+template <typename T>
+struct RadixTraits<T, enable_if_t<is_floating_point<T>::value>> {
+    using UIntType = typename FloatTraits<T>::UIntType;
+    enum : int { SIGN_BIT = int(FloatTraits<T>::SIGN_BIT) };
+    static UIntType ToKey(T f) {
+        const UIntType u = FloatToBits(f);
+        const UIntType mask = UIntType(0) - (u >> SIGN_BIT);
+        return u ^ (mask | UIntType(FloatTraits<T>::BIT_MASK));
+    }
+    static T FromKey(UIntType u) {
+        const UIntType mask = (u >> SIGN_BIT) - UIntType(1);
+        return BitsToFloat<T>(u ^ (mask | UIntType(FloatTraits<T>::BIT_MASK)));
+    }
+};
+
+template <typename T>
+struct RadixTraits<T, enable_if_t<is_integral<T>::value>> {
+    using UIntType = make_unsigned_t<T>;
+    enum : int { SIGN_BIT = 8 * sizeof(T) - 1 };
+    static constexpr UIntType FLIP =
+        is_signed<T>::value ? UIntType(1) << SIGN_BIT : 0;
+    static UIntType ToKey(T i) { return UIntType(i) ^ FLIP; }
+    static T FromKey(UIntType u) { return T(u ^ FLIP); }
+};
+
+//------------------------------------------------------------------------------
+namespace {
+struct NoPayload {};
+
+// Scatter [first, last) of src into dest by digit at shift, offsets are the
+// start positions of each bucket and are updated
+template <int DIGIT_BITS, typename U, typename V>
+void Scatter(const U* src, U* dest, const V* vsrc, V* vdest, size_t first,
+             size_t last, int shift, size_t* offsets) {
+    constexpr U MASK = (U(1) << DIGIT_BITS) - 1;
+    for (size_t i = first; i != last; ++i) {
+        const size_t o = offsets[(src[i] >> shift) & MASK]++;
+        dest[o] = src[i];
+        if constexpr (!is_same<V, NoPayload>::value) vdest[o] = move(vsrc[i]);
+    }
+}
+
+// One pass per digit, ping-ponging between the two buffers; passes where all
+// keys share the same digit are skipped. Returns true if the sorted data
+// ended up in the temporary buffers
+template <int DIGIT_BITS, typename U, typename V>
+bool RadixPasses(U* keys, U* tmp, V* values, V* vtmp, size_t n,
+                 unsigned threads) {
+    constexpr int BITS = 8 * sizeof(U);
+    constexpr int PASSES = (BITS + DIGIT_BITS - 1) / DIGIT_BITS;
+    constexpr size_t BUCKETS = size_t(1) << DIGIT_BITS;
+    constexpr U MASK = U(BUCKETS - 1);
+    // histograms for all digits in a single read
+    vector<size_t> hist(PASSES * BUCKETS, 0);
+    for (size_t i = 0; i != n; ++i) {
+        for (int p = 0; p != PASSES; ++p)
+            ++hist[p * BUCKETS + ((keys[i] >> (p * DIGIT_BITS)) & MASK)];
+    }
+    const size_t chunk = (n + threads - 1) / threads;
+    vector<size_t> offsets(threads * BUCKETS);
+    bool swapped = false;
+    for (int p = 0; p != PASSES; ++p) {
+        const size_t* h = &hist[p * BUCKETS];
+        const int shift = p * DIGIT_BITS;
+        if (*max_element(h, h + BUCKETS) == n) continue;
+        if (threads == 1) {
+            for (size_t b = 0, sum = 0; b != BUCKETS; sum += h[b++])
+                offsets[b] = sum;
+            Scatter<DIGIT_BITS>(keys, tmp, values, vtmp, 0, n, shift,
+                                offsets.data());
+        } else {
+            // per-thread histograms: thread t writes each bucket right after
+            // threads 0..t-1, keeping the sort stable
+            vector<thread> workers;
+            fill(offsets.begin(), offsets.end(), 0);
+            for (unsigned t = 0; t != threads; ++t) {
+                workers.emplace_back([&, t] {
+                    size_t* o = &offsets[t * BUCKETS];
+                    const size_t last = min(n, chunk * (t + 1));
+                    for (size_t i = chunk * t; i < last; ++i)
+                        ++o[(keys[i] >> shift) & MASK];
+                });
+            }
+            for (auto& w : workers) w.join();
+            workers.clear();
+            for (size_t b = 0, sum = 0; b != BUCKETS; ++b) {
+                for (unsigned t = 0; t != threads; ++t) {
+                    const size_t c = offsets[t * BUCKETS + b];
+                    offsets[t * BUCKETS + b] = sum;
+                    sum += c;
+                }
+            }
+            for (unsigned t = 0; t != threads; ++t) {
+                workers.emplace_back([&, t] {
+                    const size_t first = min(n, chunk * t);
+                    const size_t last = min(n, chunk * (t + 1));
+                    Scatter<DIGIT_BITS>(keys, tmp, values, vtmp, first, last,
+                                        shift, &offsets[t * BUCKETS]);
+                });
+            }
+            for (auto& w : workers) w.join();
+        }
+        swap(keys, tmp);
+        swap(values, vtmp);
+        swapped = !swapped;
+    }
+    return swapped;
+}
+}  // namespace
+
+//------------------------------------------------------------------------------
+// Stable sort of keys, DIGIT_BITS: 8 or 11 bit digits, threads: number of
+// threads used by each pass
+template <int DIGIT_BITS = 8, typename K>
+void RadixSort(K* keys, size_t n, unsigned threads = 1) {
+    static_assert(DIGIT_BITS > 0 && DIGIT_BITS <= 16);
+    using RT = RadixTraits<K>;
+    using U = typename RT::UIntType;
+    vector<U> k(n), tmp(n);
+    for (size_t i = 0; i != n; ++i) k[i] = RT::ToKey(keys[i]);
+    const bool swapped = RadixPasses<DIGIT_BITS, U, NoPayload>(
+        k.data(), tmp.data(), nullptr, nullptr, n, max(1u, threads));
+    const U* sorted = swapped ? tmp.data() : k.data();
+    for (size_t i = 0; i != n; ++i) keys[i] = RT::FromKey(sorted[i]);
+}
+
+// Stable sort of keys, values[i] moves together with keys[i]
+template <int DIGIT_BITS = 8, typename K, typename V>
+void RadixSort(K* keys, V* values, size_t n, unsigned threads = 1) {
+    static_assert(DIGIT_BITS > 0 && DIGIT_BITS <= 16);
+    using RT = RadixTraits<K>;
+    using U = typename RT::UIntType;
+    vector<U> k(n), tmp(n);
+    vector<V> vtmp(n);
+    for (size_t i = 0; i != n; ++i) k[i] = RT::ToKey(keys[i]);
+    const bool swapped = RadixPasses<DIGIT_BITS>(
+        k.data(), tmp.data(), values, vtmp.data(), n, max(1u, threads));
+    const U* sorted = swapped ? tmp.data() : k.data();
+    for (size_t i = 0; i != n; ++i) keys[i] = RT::FromKey(sorted[i]);
+    if (swapped) move(vtmp.begin(), vtmp.end(), values);
+}
+
+template <int DIGIT_BITS = 8, typename K>
+void RadixSort(vector<K>& keys, unsigned threads = 1) {
+    RadixSort<DIGIT_BITS>(keys.data(), keys.size(), threads);
+}
+
+// RadixSort(Zip(keys, values)): key and value sequences must be contiguous
+template <int DIGIT_BITS = 8, typename KeyIt, typename ValueIt>
+void RadixSort(pair<Zipper<KeyIt, ValueIt>, Zipper<KeyIt, ValueIt>> zip,
+               unsigned threads = 1) {
+    const auto& first = zip.first.Iterators();
+    const auto& last = zip.second.Iterators();
+    const size_t n = size_t(get<0>(last) - get<0>(first));
+    assert(size_t(get<1>(last) - get<1>(first)) == n);
+    if (!n) return;
+    RadixSort<DIGIT_BITS>(&*get<0>(first), &*get<1>(first), n, threads);
+}
+
+//------------------------------------------------------------------------------
+using Clock = chrono::high_resolution_clock;
+template <typename TimeDiffNsT>
+constexpr double NsToSec(const TimeDiffNsT& diff) {
+    return double(chrono::duration_cast<chrono::nanoseconds>(diff).count()) /
+           1E9;
+}
+
+template <typename F>
+double Time(F f) {
+    const auto start = Clock::now();
+    f();
+    return NsToSec(Clock::now() - start);
+}
+
+template <typename T>
+vector<T> RandomKeys(size_t n) {
+    mt19937_64 gen(n);
+    normal_distribution<T> dist(0, 1E6);
+    vector<T> v(n);
+    for (auto& x : v) x = dist(gen);
+    return v;
+}
+
+template <typename T>
+void Benchmark(const char* type, size_t n, unsigned threads) {
+    const vector<T> keys = RandomKeys<T>(n);
+    vector<T> ref = keys;
+    const double tstd = Time([&] { sort(ref.begin(), ref.end()); });
+    cout << type << " " << n << " keys, M keys/s" << endl;
+    cout << "  std::sort:              " << n / tstd / 1E6 << endl;
+    auto run = [&](const char* label, auto sortFun) {
+        vector<T> k = keys;
+        const double t = Time([&] { sortFun(k); });
+        cout << "  " << label << n / t / 1E6 << (k == ref ? "" : " ERROR")
+             << endl;
+    };
+    run("radix 8 bit:            ", [](vector<T>& k) { RadixSort<8>(k); });
+    run("radix 11 bit:           ", [](vector<T>& k) { RadixSort<11>(k); });
+    if (threads > 1) {
+        run("radix 8 bit threaded:   ",
+            [threads](vector<T>& k) { RadixSort<8>(k, threads); });
+        run("radix 11 bit threaded:  ",
+            [threads](vector<T>& k) { RadixSort<11>(k, threads); });
+    }
+    // key + 32 bit payload
+    vector<pair<T, uint32_t>> pairs(n);
+    for (size_t i = 0; i != n; ++i) pairs[i] = {keys[i], uint32_t(i)};
+    const double tpairs = Time([&] {
+        stable_sort(pairs.begin(), pairs.end(),
+                    [](auto& a, auto& b) { return a.first < b.first; });
+    });
+    vector<T> k = keys;
+    vector<uint32_t> v(n);
+    for (size_t i = 0; i != n; ++i) v[i] = uint32_t(i);
+    const double tzip = Time([&] { RadixSort<11>(Zip(k, v), threads); });
+    bool ok = true;
+    for (size_t i = 0; i != n; ++i)
+        ok = ok && pairs[i].first == k[i] && pairs[i].second == v[i];
+    cout << "  key+value std::stable_sort: " << n / tpairs / 1E6 << endl;
+    cout << "  key+value RadixSort(Zip):   " << n / tzip / 1E6
+         << (ok ? "" : " ERROR") << endl;
+}
+
+//------------------------------------------------------------------------------
+int main(int argc, char const* argv[]) {
+    vector<float> f = {3.f, -0.f, 0.f, -1.5f, 1E-40f, -1E-40f,
+                       -numeric_limits<float>::infinity(), 2.f};
+    vector<int> payload = {0, 1, 2, 3, 4, 5, 6, 7};
+    RadixSort(Zip(f, payload));
+    for (auto [k, v] : Zip(f, payload)) cout << "{" << k << ", " << v << "} ";
+    cout << endl;
+    const size_t maxSize = argc > 1 ? stoull(argv[1]) : size_t(1) << 24;
+    const unsigned threads =
+        argc > 2 ? stoul(argv[2]) : max(1u, thread::hardware_concurrency());
+    for (size_t n = size_t(1) << 20; n <= maxSize; n *= 4) {
+        Benchmark<float>("float", n, threads);
+        Benchmark<double>("double", n, threads);
+    }
+    return 0;
+}
@@ -0,0 +1,141 @@
+// Author: Ugo Varetto
+// Raw aligned buffer: no initialization of elements on allocation, optionally
+// page locked; buffers of LargeBlockCache::MinBytes() or more are mappings
+// recycled through the large block cache
+
+#pragma once
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "large_block_cache.h"
+
+class RawBuffer {
+   public:
+    RawBuffer(std::size_t size, std::size_t alignment = sizeof(void*))
+        : data_(nullptr),
+          size_(0),
+          alignment_(alignment),
+          pageLocked_(false),
+          cached_(false) {
+        // only way to report failure in constructor is to throw
+        // exceptions, check for size after construction, if zero
+        // an error occurred
+        Allocate(size, alignment);
+    }
+    RawBuffer(const RawBuffer& other)
+        : data_(nullptr),
+          size_(0),
+          alignment_(other.alignment_),
+          pageLocked_(false),
+          cached_(false) {
+        Allocate(other.size_, other.alignment_);
+#ifndef NO_STD_COPY
+        if (size_) {
+            // will call the right function e.g. __memcpy_avx_unaligned() etc.
+            // but required including <algorithm>
+            std::copy(other.data_, other.data_ + size_, data_);
+        }
+#else
+        std::memcpy(data_, other.data_, size_);
+#endif
+    }
+    RawBuffer(RawBuffer&& other) {
+        size_ = other.size_;
+        data_ = other.data_;
+        alignment_ = other.alignment_;
+        pageLocked_ = other.pageLocked_;
+        cached_ = other.cached_;
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+    ~RawBuffer() { Destroy(); }
+    const char* Data() const { return data_; }
+    char* Data() { return data_; }
+    std::size_t Size() const { return size_; };
+    std::size_t Alignment() const { return alignment_; }
+    char& operator[](std::size_t i) { return data_[i]; }
+    char operator[](std::size_t i) const {
+        return data_[i];
+    }  // no ref required
+
+   private:
+    void Allocate(std::size_t size, std::size_t alignment) {
+        LargeBlockCache& cache = LargeBlockCache::Instance();
+        if (size >= cache.MinBytes()) {
+            data_ = static_cast<char*>(cache.Allocate(size, alignment));
+            cached_ = true;
+        } else {
+            data_ = static_cast<char*>(std::aligned_alloc(alignment, size));
+        }
+        if (data_) size_ = size;
+    }
+    void Destroy() {
+        if (!data_) return;
+        if (pageLocked_) munlock(data_, size_);
+        if (cached_) {
+            LargeBlockCache::Instance().Release(data_);
+        } else {
+            std::free(data_);
+        }
+    }
+
+   private:
+    char* data_;
+    std::size_t size_;
+    std::size_t alignment_;
+    bool pageLocked_;
+    bool cached_;
+
+   private:
+    // only used by friend functions to return empty buffer in case of errors
+    RawBuffer()
+        : data_(nullptr),
+          size_(0),
+          alignment_(0),
+          pageLocked_(false),
+          cached_(false) {}
+    friend RawBuffer PageLockedBuffer(std::size_t);
+    friend void CopyBuffer(const RawBuffer& src, RawBuffer& dest);
+    // friend RawBuffer MMAlignedBuffer(size_t, size_t); //_mm_malloc/free of
+    // intrinsics TBD
+};
+
+inline RawBuffer PageLockedBuffer(std::size_t size) {
+    RawBuffer rb(size, sysconf(_SC_PAGESIZE));
+    if (!rb.Size()) return RawBuffer();
+    if (mlock(rb.Data(), size)) return RawBuffer();
+    rb.pageLocked_ = true;
+    return rb;
+}
+
+// 2 MiB aligned buffer, size rounded up to a multiple of 2 MiB, backed by
+// transparent huge pages when the kernel allows it (madvise mode)
+inline RawBuffer HugePageBuffer(std::size_t size) {
+    const std::size_t HUGE_PAGE = std::size_t(1) << 21;
+    RawBuffer rb((size + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE, HUGE_PAGE);
+#ifdef MADV_HUGEPAGE
+    if (rb.Size()) madvise(rb.Data(), rb.Size(), MADV_HUGEPAGE);
+#endif
+    return rb;
+}
+
+inline void CopyBuffer(const RawBuffer& src, RawBuffer& dest) {
+    const std::size_t sz = src.size_ <= dest.size_ ? src.size_ : dest.size_;
+#ifndef NO_STD_COPY
+    std::copy(src.data_, src.data_ + sz, dest.data_);
+#else
+    std::memcpy(dest.data_, src.data_, sz);
+#endif
+}
+
+inline char* begin(RawBuffer& rb) { return rb.Data(); }
+inline char* end(RawBuffer& rb) { return rb.Data() + rb.Size(); }
+inline const char* begin(const RawBuffer& rb) { return rb.Data(); }
+inline const char* end(const RawBuffer& rb) { return rb.Data() + rb.Size(); }
+inline const char* cbegin(const RawBuffer& rb) { return rb.Data(); }
+inline const char* cend(const RawBuffer& rb) { return rb.Data() + rb.Size(); }
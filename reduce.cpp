@@ -0,0 +1,126 @@
+//
+// Tree and multi-accumulator reductions vs folds: throughput and float
+// rounding error summing blocks of 8 to 256 operands
+// Usage: reduce [passes, default 16384]
+// Author: Ugo Varetto
+//
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "reduce.h"
+
+using namespace std;
+
+using Clock = chrono::high_resolution_clock;
+template <typename TimeDiffNsT>
+constexpr double NsToSec(const TimeDiffNsT& diff) {
+    return double(chrono::duration_cast<chrono::nanoseconds>(diff).count()) /
+           1E9;
+}
+
+//------------------------------------------------------------------------------
+static_assert(ReducePack<int>(plus<>(), 1, 2, 3, 4, 5, 6, 7) == 28);
+static_assert(ReducePack<double, 2>(plus<>(), 1, 2.5f, 3.5) == 7);
+static_assert(Reduce<3>(multiplies<>(), {1, 2, 3, 4, 5, 6, 7, 8}) == 40320);
+static_assert(TreeSum<4>(array<int, 9>{1, 2, 3, 4, 5, 6, 7, 8, 9}) == 45);
+
+//------------------------------------------------------------------------------
+// Sum in concepts.cpp: left fold
+template <typename T, size_t... I>
+T LeftFold(const T* a, index_sequence<I...>) {
+    return (... + a[I]);
+}
+
+// Apply in variadic-templates.cpp: right recursive, f(head, Apply(tail))
+template <typename T, size_t... I>
+T RightFold(const T* a, index_sequence<I...>) {
+    return (a[I] + ... + T(0));
+}
+
+template <size_t N>
+struct Methods {
+    using T = float;
+    static T Left(const T* a) { return LeftFold(a, make_index_sequence<N>()); }
+    static T Right(const T* a) {
+        return RightFold(a, make_index_sequence<N>());
+    }
+    template <size_t K>
+    static T Tree(const T* a) {
+        return ReduceN<N, K>(plus<>(), a);
+    }
+};
+
+struct Result {
+    double ns;     // per operand
+    double error;  // mean relative error
+};
+
+// Sum every block of N values in data, passes times
+template <size_t N, typename F>
+Result Run(F sum, const vector<float>& data, const vector<double>& ref,
+           int passes) {
+    const size_t blocks = data.size() / N;
+    float check = 0;
+    const auto start = Clock::now();
+    for (int p = 0; p != passes; ++p) {
+        for (size_t b = 0; b != blocks; ++b) check += sum(&data[b * N]);
+    }
+    const double t = NsToSec(Clock::now() - start);
+    double error = 0;
+    for (size_t b = 0; b != blocks; ++b) {
+        error += abs(double(sum(&data[b * N])) - ref[b]) / ref[b];
+    }
+    // keep the sums alive
+    if (check == -1) cout << check;
+    return {1E9 * t / (double(passes) * blocks * N), error / blocks};
+}
+
+template <size_t N>
+void Bench(const vector<float>& data, int passes) {
+    vector<double> ref(data.size() / N, 0.0);
+    for (size_t i = 0; i != ref.size() * N; ++i) ref[i / N] += data[i];
+    using M = Methods<N>;
+    const Result r[] = {
+        Run<N>(M::Left, data, ref, passes),
+        Run<N>(M::Right, data, ref, passes),
+        Run<N>(M::template Tree<0>, data, ref, passes),
+        Run<N>(M::template Tree<2>, data, ref, passes),
+        Run<N>(M::template Tree<4>, data, ref, passes),
+        Run<N>(M::template Tree<8>, data, ref, passes),
+        Run<N>(M::template Tree<AUTO_ACCUMULATORS>, data, ref, passes)};
+    cout << setw(5) << N;
+    for (const Result& x : r) cout << setw(8) << setprecision(3) << x.ns;
+    cout << "  |";
+    for (const Result& x : r) cout << setw(9) << setprecision(2) << x.error;
+    cout << endl;
+}
+
+template <size_t... N>
+void BenchAll(const vector<float>& data, int passes) {
+    (..., Bench<N>(data, passes));
+}
+
+//------------------------------------------------------------------------------
+int main(int argc, char const* argv[]) {
+    const int passes = argc > 1 ? stoi(argv[1]) : 16384;
+    // 64 KiB: in cache, the reduction is the bottleneck
+    vector<float> data(1 << 14);
+    mt19937 gen(3);
+    uniform_real_distribution<float> dist(0.f, 1.f);
+    for (auto& f : data) f = dist(gen);
+    cout << "float sums, ns/operand and mean relative error" << endl
+         << "    N    left   right    tree   K = 2   K = 4   K = 8    auto  |"
+         << "     left    right     tree    K = 2    K = 4    K = 8     auto"
+         << endl;
+    BenchAll<8, 16, 32, 64, 128, 256>(data, passes);
+    return 0;
+}
@@ -0,0 +1,107 @@
+// Author: Ugo Varetto
+// Tree shaped reductions over parameter packs and fixed size arrays.
+// A fold (... + x) is a chain of N - 1 dependent operations: throughput is
+// bound by the latency of the operation and, for floating point, the
+// rounding error grows as O(N).
+// Reduce<0> combines operands as a balanced pairwise tree: depth log2(N),
+// independent operations at each level, error O(log N).
+// Reduce<K> streams operands through K independent accumulators, K chains
+// in flight at once, then combines the accumulators as a pairwise tree.
+// N and K are compile time constants: trees are fully unrolled, the
+// accumulator loop has constant bounds; with 8 accumulators the compiler
+// maps the loop onto vector adds.
+// The default K = AUTO_ACCUMULATORS picks a tree for up to 32 operands and
+// 8 accumulators above that (a fully unrolled tree over hundreds of
+// operands runs out of registers).
+// Operations must be associative for the result to match a fold (exactly
+// for integers, up to rounding for floating point).
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+constexpr std::size_t AUTO_ACCUMULATORS = ~std::size_t(0);
+
+namespace reduce_detail {
+// pairwise tree over a[B, E)
+template <std::size_t B, std::size_t E, typename T, typename F>
+constexpr T Tree(F f, const T* a) {
+    static_assert(E > B, "empty reduction");
+    if constexpr (E - B == 1) {
+        return a[B];
+    } else {
+        constexpr std::size_t M = B + (E - B) / 2;
+        return T(f(Tree<B, M>(f, a), Tree<M, E>(f, a)));
+    }
+}
+
+// accumulator k combines a[k], a[k + K], a[k + 2K]...; the N % K trailing
+// elements go to the first accumulators
+template <std::size_t K, std::size_t N, typename T, typename F,
+          std::size_t... I>
+constexpr T Accumulators(F f, const T* a, std::index_sequence<I...>) {
+    std::array<T, K> acc = {a[I]...};
+    for (std::size_t i = K; i + K <= N; i += K) {
+        for (std::size_t k = 0; k != K; ++k) acc[k] = T(f(acc[k], a[i + k]));
+    }
+    constexpr std::size_t TAIL = N % K;
+    for (std::size_t k = 0; k != TAIL; ++k)
+        acc[k] = T(f(acc[k], a[N - TAIL + k]));
+    return Tree<0, K>(f, acc.data());
+}
+
+template <std::size_t K, std::size_t N, typename T, typename F>
+constexpr T Reduce(F f, const T* a) {
+    static_assert(N > 0, "empty reduction");
+    if constexpr (K == AUTO_ACCUMULATORS) {
+        return Reduce<N <= 32 ? 0 : 8, N>(f, a);
+    } else if constexpr (K == 0 || K >= N) {
+        return Tree<0, N>(f, a);
+    } else {
+        return Accumulators<K, N>(f, a, std::make_index_sequence<K>());
+    }
+}
+}  // namespace reduce_detail
+
+//------------------------------------------------------------------------------
+// K == 0: pairwise tree, K > 0: K accumulators combined as a tree,
+// AUTO_ACCUMULATORS: chosen from N
+// N elements starting at a
+template <std::size_t N, std::size_t K = AUTO_ACCUMULATORS, typename T,
+          typename F>
+constexpr T ReduceN(F f, const T* a) {
+    return reduce_detail::Reduce<K, N>(f, a);
+}
+
+template <std::size_t K = AUTO_ACCUMULATORS, typename T, std::size_t N,
+          typename F>
+constexpr T Reduce(F f, const T (&a)[N]) {
+    return reduce_detail::Reduce<K, N>(f, a);
+}
+
+template <std::size_t K = AUTO_ACCUMULATORS, typename T, std::size_t N,
+          typename F>
+constexpr T Reduce(F f, const std::array<T, N>& a) {
+    return reduce_detail::Reduce<K, N>(f, a.data());
+}
+
+// Operands are converted to T first
+template <typename T, std::size_t K = AUTO_ACCUMULATORS, typename F,
+          typename... ArgsT>
+constexpr T ReducePack(F f, const ArgsT&... args) {
+    const T a[] = {T(args)...};
+    return reduce_detail::Reduce<K, sizeof...(ArgsT)>(f, a);
+}
+
+template <std::size_t K = AUTO_ACCUMULATORS, typename T, std::size_t N>
+constexpr T TreeSum(const T (&a)[N]) {
+    return Reduce<K>(std::plus<>(), a);
+}
+
+template <std::size_t K = AUTO_ACCUMULATORS, typename T, std::size_t N>
+constexpr T TreeSum(const std::array<T, N>& a) {
+    return Reduce<K>(std::plus<>(), a);
+}
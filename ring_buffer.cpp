@@ -0,0 +1,150 @@
+//
+// Streaming messages through a ring: double mapped RingBuffer (contiguous
+// windows) vs a RawBuffer ring that splits wrapped writes in two and copies
+// wrapped reads into a scratch buffer; messages of 64 B to 1 MiB, each
+// preceded by a 4 byte length, written and then checksummed in place
+// Usage: ring_buffer [ring size in MiB, default 4]
+//                    [bytes streamed per message size in MiB, default 1024]
+// Author: Ugo Varetto
+//
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "raw_buffer.h"
+#include "ring_buffer.h"
+
+using namespace std;
+
+using Clock = chrono::high_resolution_clock;
+template <typename TimeDiffNsT>
+constexpr double NsToSec(const TimeDiffNsT& diff) {
+    return double(chrono::duration_cast<chrono::nanoseconds>(diff).count()) /
+           1E9;
+}
+
+//------------------------------------------------------------------------------
+class CopyRing {
+   public:
+    explicit CopyRing(size_t size) : buffer_(size, 64), scratch_(size, 64) {}
+    size_t Size() const { return buffer_.Size(); }
+    size_t Readable() const { return size_t(write_ - read_); }
+    size_t Writable() const { return Size() - Readable(); }
+    void Write(const char* p, size_t n) {
+        const size_t w = write_ % Size();
+        const size_t first = min(n, Size() - w);
+        memcpy(buffer_.Data() + w, p, first);
+        memcpy(buffer_.Data(), p + first, n - first);
+        write_ += n;
+    }
+    // n contiguous bytes, in the scratch buffer if they wrap
+    const char* Read(size_t n) {
+        const size_t r = read_ % Size();
+        if (r + n <= Size()) return buffer_.Data() + r;
+        const size_t first = Size() - r;
+        memcpy(scratch_.Data(), buffer_.Data() + r, first);
+        memcpy(scratch_.Data() + first, buffer_.Data(), n - first);
+        return scratch_.Data();
+    }
+    void Consume(size_t n) { read_ += n; }
+
+   private:
+    RawBuffer buffer_;
+    RawBuffer scratch_;
+    uint64_t read_ = 0;
+    uint64_t write_ = 0;
+};
+
+uint64_t Checksum(const char* p, size_t n) {
+    uint64_t s = 0;
+    for (size_t i = 0; i != n; ++i) s += uint8_t(p[i]);
+    return s;
+}
+
+// fill the ring, drain it, repeat until total message bytes are consumed:
+// GB/s
+double Mirrored(RingBuffer& ring, size_t total, const vector<char>& message,
+                uint64_t& check) {
+    const uint32_t len = uint32_t(message.size());
+    check = 0;
+    size_t streamed = 0;
+    const auto start = Clock::now();
+    while (streamed < total) {
+        while (ring.Writable() >= sizeof(len) + len) {
+            char* w = ring.WritePtr();
+            memcpy(w, &len, sizeof(len));
+            memcpy(w + sizeof(len), message.data(), len);
+            ring.Produce(sizeof(len) + len);
+        }
+        while (ring.Readable()) {
+            const char* r = ring.ReadPtr();
+            uint32_t l;
+            memcpy(&l, r, sizeof(l));
+            check += Checksum(r + sizeof(l), l);
+            ring.Consume(sizeof(l) + l);
+            streamed += l;
+        }
+    }
+    return streamed / NsToSec(Clock::now() - start) / 1E9;
+}
+
+double Copying(CopyRing& ring, size_t total, const vector<char>& message,
+               uint64_t& check) {
+    const uint32_t len = uint32_t(message.size());
+    check = 0;
+    size_t streamed = 0;
+    const auto start = Clock::now();
+    while (streamed < total) {
+        while (ring.Writable() >= sizeof(len) + len) {
+            ring.Write(reinterpret_cast<const char*>(&len), sizeof(len));
+            ring.Write(message.data(), len);
+        }
+        while (ring.Readable()) {
+            uint32_t l;
+            memcpy(&l, ring.Read(sizeof(l)), sizeof(l));
+            ring.Consume(sizeof(l));
+            check += Checksum(ring.Read(l), l);
+            ring.Consume(l);
+            streamed += l;
+        }
+    }
+    return streamed / NsToSec(Clock::now() - start) / 1E9;
+}
+
+//------------------------------------------------------------------------------
+int main(int argc, char const* argv[]) {
+    const size_t size = (argc > 1 ? stoull(argv[1]) : 4) << 20;
+    const size_t total = (argc > 2 ? stoull(argv[2]) : 1024) << 20;
+    RingBuffer ring(size);
+    CopyRing copy(ring.Size());
+    if (!ring.Size() || !copy.Size()) {
+        cerr << "ERROR: cannot allocate ring" << endl;
+        return 1;
+    }
+    // the second mapping aliases the first
+    ring.Data()[0] = 'x';
+    if (ring.Data()[ring.Size()] != 'x') {
+        cerr << "ERROR: ring not mirrored" << endl;
+        return 1;
+    }
+    cout << setprecision(3) << ring.Size() / 1024 << " KiB ring, GB/s"
+         << endl
+         << " message  double mapped  copy on wrap" << endl;
+    bool ok = true;
+    for (size_t m = 64; m <= min(size_t(1) << 20, ring.Size() / 2); m *= 4) {
+        vector<char> message(m);
+        for (size_t i = 0; i != m; ++i) message[i] = char(i * 7);
+        uint64_t c[2];
+        const double tm = Mirrored(ring, total, message, c[0]);
+        const double tc = Copying(copy, total, message, c[1]);
+        ok = ok && c[0] == c[1];
+        cout << setw(8) << m << setw(15) << tm << setw(14) << tc << endl;
+    }
+    cout << (ok ? "results match" : "ERROR: results differ") << endl;
+    return ok ? 0 : 1;
+}
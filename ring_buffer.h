@@ -0,0 +1,96 @@
+// Author: Ugo Varetto
+// Ring buffer whose pages are mapped twice, back to back: byte i and byte
+// i + Size() are the same memory, so any read or write window of up to
+// Size() bytes starting anywhere in the ring is contiguous, no copy of the
+// wrapped part needed.
+// The memory is a memfd (Linux) mapped at both halves of a reserved address
+// range; Size() is the requested size rounded up to a multiple of the page
+// size.
+// As for RawBuffer, check Size() after construction, zero means failure.
+// Not thread safe.
+//   RingBuffer ring(1 << 20);
+//   memcpy(ring.WritePtr(), msg, n);   // n <= ring.Writable()
+//   ring.Produce(n);
+//   Parse(ring.ReadPtr(), ring.Readable());
+//   ring.Consume(parsed);
+
+#pragma once
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+
+class RingBuffer {
+   public:
+    explicit RingBuffer(std::size_t size)
+        : data_(nullptr), size_(0), read_(0), write_(0) {
+        Map(size);
+    }
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+    RingBuffer(RingBuffer&& other)
+        : data_(other.data_),
+          size_(other.size_),
+          read_(other.read_),
+          write_(other.write_) {
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+    ~RingBuffer() {
+        if (data_) munmap(data_, 2 * size_);
+    }
+    // start of the first mapping, 2 * Size() bytes addressable
+    const char* Data() const { return data_; }
+    char* Data() { return data_; }
+    std::size_t Size() const { return size_; }
+    // bytes written and not consumed
+    std::size_t Readable() const { return std::size_t(write_ - read_); }
+    std::size_t Writable() const { return size_ - Readable(); }
+    // contiguous for Readable() bytes
+    const char* ReadPtr() const { return data_ + read_ % size_; }
+    // contiguous for Writable() bytes
+    char* WritePtr() { return data_ + write_ % size_; }
+    void Produce(std::size_t n) { write_ += n; }
+    void Consume(std::size_t n) { read_ += n; }
+
+   private:
+    void Map(std::size_t size) {
+#ifdef __linux__
+        const std::size_t page = std::size_t(sysconf(_SC_PAGESIZE));
+        size = (size + page - 1) / page * page;
+        if (!size) return;
+        const int fd = memfd_create("RingBuffer", 0);
+        if (fd < 0) return;
+        if (ftruncate(fd, off_t(size))) {
+            close(fd);
+            return;
+        }
+        // reserve both halves, then map the file over each of them
+        void* r = mmap(nullptr, 2 * size, PROT_NONE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        char* p = static_cast<char*>(r);
+        if (r == MAP_FAILED ||
+            mmap(p, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd,
+                 0) == MAP_FAILED ||
+            mmap(p + size, size, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+            if (r != MAP_FAILED) munmap(r, 2 * size);
+            close(fd);
+            return;
+        }
+        // the mappings keep the memory alive
+        close(fd);
+        data_ = p;
+        size_ = size;
+#endif
+    }
+
+   private:
+    char* data_;
+    std::size_t size_;
+    // monotonic byte counters, positions modulo size_
+    uint64_t read_;
+    uint64_t write_;
+};
@@ -0,0 +1,103 @@
+//
+// Request path scratch buffers: RawBuffer vs SmallRawBuffer<256>, heap
+// allocations and ns per request (construct, fill, copy, checksum,
+// destroy) for request sizes of 16 B to 4 KiB and for a mix with 90% of
+// the requests under 256 bytes
+// Usage: small_raw_buffer [num requests, default 2^22]
+// Author: Ugo Varetto
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "raw_buffer.h"
+#include "small_raw_buffer.h"
+
+using namespace std;
+
+using Clock = chrono::high_resolution_clock;
+template <typename TimeDiffNsT>
+constexpr double NsToSec(const TimeDiffNsT& diff) {
+    return double(chrono::duration_cast<chrono::nanoseconds>(diff).count()) /
+           1E9;
+}
+
+//------------------------------------------------------------------------------
+using Small = SmallRawBuffer<256>;
+
+// heap allocations per buffer construction or copy
+size_t Allocations(const RawBuffer&) { return 1; }
+size_t Allocations(const Small& b) { return b.Inline() ? 0 : 1; }
+
+template <typename BufferT>
+uint64_t Request(size_t size, size_t& allocations) {
+    BufferT b(size, 16);
+    fill(begin(b), end(b), char(size));
+    const BufferT copy(b);
+    CopyBuffer(copy, b);
+    allocations += Allocations(b) + Allocations(copy);
+    uint64_t s = 0;
+    for (const char c : copy) s += uint8_t(c);
+    return s;
+}
+
+// ns per request
+template <typename BufferT>
+double Time(const vector<size_t>& sizes, uint64_t& check,
+            size_t& allocations) {
+    check = 0;
+    allocations = 0;
+    const auto start = Clock::now();
+    for (size_t s : sizes) check += Request<BufferT>(s, allocations);
+    return 1E9 * NsToSec(Clock::now() - start) / sizes.size();
+}
+
+bool Bench(const string& label, const vector<size_t>& sizes) {
+    uint64_t c[2];
+    size_t a[2];
+    const double traw = Time<RawBuffer>(sizes, c[0], a[0]);
+    const double tsmall = Time<Small>(sizes, c[1], a[1]);
+    cout << setw(8) << label << setw(12) << traw << setw(12) << tsmall
+         << setw(14) << double(a[0]) / sizes.size() << setw(14)
+         << double(a[1]) / sizes.size() << endl;
+    return c[0] == c[1];
+}
+
+//------------------------------------------------------------------------------
+int main(int argc, char const* argv[]) {
+    const size_t requests = argc > 1 ? stoull(argv[1]) : size_t(1) << 22;
+    // interface
+    Small s(100);
+    Small big(1000);
+    Small moved(std::move(s));
+    RawBuffer rb(100);
+    fill(begin(rb), end(rb), 'x');
+    CopyBuffer(rb, moved);
+    if (!moved.Inline() || big.Inline() || moved[99] != 'x' ||
+        uintptr_t(moved.Data()) % 64 != 0) {
+        cerr << "ERROR: wrong buffer" << endl;
+        return 1;
+    }
+    cout << setprecision(3) << "ns/request, heap allocations/request" << endl
+         << "    size   RawBuffer  SmallRawBuffer  RawBuffer  SmallRawBuffer"
+         << endl;
+    bool ok = true;
+    for (size_t size : {16, 64, 128, 256, 1024, 4096}) {
+        ok = Bench(to_string(size), vector<size_t>(requests, size)) && ok;
+    }
+    // 90% in [16, 256], 10% in [256, 4096]
+    mt19937 gen(1);
+    vector<size_t> mix(requests);
+    for (auto& m : mix) {
+        m = gen() % 10 ? 16 + gen() % 241 : 256 + gen() % 3841;
+    }
+    ok = Bench("mix", mix) && ok;
+    cout << (ok ? "results match" : "ERROR: results differ") << endl;
+    return ok ? 0 : 1;
+}
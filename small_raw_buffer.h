@@ -0,0 +1,111 @@
+// Author: Ugo Varetto
+// RawBuffer with inline storage: buffers of up to InlineBytes bytes with
+// alignment up to InlineAlignment live inside the object, no allocation on
+// construction and copy; larger buffers spill to a RawBuffer.
+// Same interface as RawBuffer; as for RawBuffer a zero Size() after
+// construction of a non empty buffer means allocation failure.
+// Moving an inline buffer copies its bytes.
+//   SmallRawBuffer<256> scratch(n);   // no allocation if n <= 256
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <optional>
+#include <utility>
+
+#include "raw_buffer.h"
+
+template <std::size_t InlineBytes, std::size_t InlineAlignment = 64>
+class SmallRawBuffer {
+   public:
+    SmallRawBuffer(std::size_t size, std::size_t alignment = sizeof(void*))
+        : size_(0), alignment_(alignment) {
+        Allocate(size, alignment);
+    }
+    SmallRawBuffer(const SmallRawBuffer& other)
+        : size_(0), alignment_(other.alignment_) {
+        Allocate(other.size_, other.alignment_);
+        if (size_) std::memcpy(Data(), other.Data(), size_);
+    }
+    SmallRawBuffer(SmallRawBuffer&& other)
+        : heap_(std::move(other.heap_)),
+          size_(other.size_),
+          alignment_(other.alignment_) {
+        if (!heap_) std::memcpy(inline_, other.inline_, size_);
+        other.heap_.reset();
+        other.size_ = 0;
+    }
+    const char* Data() const { return heap_ ? heap_->Data() : inline_; }
+    char* Data() { return heap_ ? heap_->Data() : inline_; }
+    std::size_t Size() const { return size_; }
+    std::size_t Alignment() const { return alignment_; }
+    // true if the data is stored in the object
+    bool Inline() const { return !heap_; }
+    char& operator[](std::size_t i) { return Data()[i]; }
+    char operator[](std::size_t i) const { return Data()[i]; }
+
+   private:
+    void Allocate(std::size_t size, std::size_t alignment) {
+        if (size <= InlineBytes && alignment <= InlineAlignment) {
+            size_ = size;
+            return;
+        }
+        heap_.emplace(size, alignment);
+        size_ = heap_->Size();
+    }
+
+   private:
+    alignas(InlineAlignment) char inline_[InlineBytes];
+    std::optional<RawBuffer> heap_;
+    std::size_t size_;
+    std::size_t alignment_;
+};
+
+namespace small_raw_buffer_detail {
+template <typename Src, typename Dest>
+void CopyBuffer(const Src& src, Dest& dest) {
+    const std::size_t sz = src.Size() <= dest.Size() ? src.Size() : dest.Size();
+    if (sz) std::memcpy(dest.Data(), src.Data(), sz);
+}
+}  // namespace small_raw_buffer_detail
+
+template <std::size_t N, std::size_t A, std::size_t M, std::size_t B>
+void CopyBuffer(const SmallRawBuffer<N, A>& src, SmallRawBuffer<M, B>& dest) {
+    small_raw_buffer_detail::CopyBuffer(src, dest);
+}
+
+template <std::size_t N, std::size_t A>
+void CopyBuffer(const SmallRawBuffer<N, A>& src, RawBuffer& dest) {
+    small_raw_buffer_detail::CopyBuffer(src, dest);
+}
+
+template <std::size_t N, std::size_t A>
+void CopyBuffer(const RawBuffer& src, SmallRawBuffer<N, A>& dest) {
+    small_raw_buffer_detail::CopyBuffer(src, dest);
+}
+
+template <std::size_t N, std::size_t A>
+char* begin(SmallRawBuffer<N, A>& rb) {
+    return rb.Data();
+}
+template <std::size_t N, std::size_t A>
+char* end(SmallRawBuffer<N, A>& rb) {
+    return rb.Data() + rb.Size();
+}
+template <std::size_t N, std::size_t A>
+const char* begin(const SmallRawBuffer<N, A>& rb) {
+    return rb.Data();
+}
+template <std::size_t N, std::size_t A>
+const char* end(const SmallRawBuffer<N, A>& rb) {
+    return rb.Data() + rb.Size();
+}
+template <std::size_t N, std::size_t A>
+const char* cbegin(const SmallRawBuffer<N, A>& rb) {
+    return rb.Data();
+}
+template <std::size_t N, std::size_t A>
+const char* cend(const SmallRawBuffer<N, A>& rb) {
+    return rb.Data() + rb.Size();
+}
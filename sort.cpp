@@ -0,0 +1,116 @@
+//
+// Introsort with branchy, branch free Lomuto and BlockQuicksort
+// partitioning vs std::sort on random, sorted, few unique and organ pipe
+// inputs of int and double
+// Usage: sort [num elements, default 2^20] [repetitions, default 5]
+// Author: Ugo Varetto
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "sort.h"
+
+using namespace std;
+
+using Clock = chrono::high_resolution_clock;
+template <typename TimeDiffNsT>
+constexpr double NsToSec(const TimeDiffNsT& diff) {
+    return double(chrono::duration_cast<chrono::nanoseconds>(diff).count()) /
+           1E9;
+}
+
+//------------------------------------------------------------------------------
+enum class Distribution { RANDOM, SORTED, FEW_UNIQUE, ORGAN_PIPE };
+
+template <typename T>
+vector<T> Input(size_t n, Distribution d, mt19937& gen) {
+    vector<T> v(n);
+    for (size_t i = 0; i != n; ++i) {
+        switch (d) {
+            case Distribution::RANDOM:
+                v[i] = T(gen() % (1u << 30));
+                break;
+            case Distribution::SORTED:
+                v[i] = T(i);
+                break;
+            case Distribution::FEW_UNIQUE:
+                v[i] = T(gen() % 16);
+                break;
+            case Distribution::ORGAN_PIPE:
+                v[i] = T(i < n / 2 ? i : n - i);
+                break;
+        }
+    }
+    return v;
+}
+
+// minimum time over repetitions, input copied into preallocated memory
+template <typename T, typename F>
+double Time(const vector<T>& in, vector<T>& out, int reps, F sort) {
+    double tmin = 1E9;
+    for (int r = 0; r != reps; ++r) {
+        copy(in.begin(), in.end(), out.begin());
+        const auto start = Clock::now();
+        sort(out.begin(), out.end());
+        tmin = min(tmin, NsToSec(Clock::now() - start));
+    }
+    return 1E9 * tmin / in.size();
+}
+
+template <typename T>
+bool Bench(const string& type, size_t n, int reps, mt19937& gen) {
+    const char* NAMES[] = {"random", "sorted", "few unique", "organ pipe"};
+    bool ok = true;
+    using D = Distribution;
+    for (D d : {D::RANDOM, D::SORTED, D::FEW_UNIQUE, D::ORGAN_PIPE}) {
+        const vector<T> in = Input<T>(n, d, gen);
+        vector<T> ref(n), out(n);
+        const double tstd = Time(in, ref, reps, [](auto f, auto l) {
+            sort(f, l);
+        });
+        cout << setw(7) << type << setw(12) << NAMES[int(d)] << setw(10)
+             << tstd;
+        const auto check = [&](double t) {
+            ok = ok && out == ref;
+            cout << setw(10) << t;
+        };
+        check(Time(in, out, reps, [](auto f, auto l) {
+            IntroSort<PartitionMode::BRANCHY>(f, l);
+        }));
+        check(Time(in, out, reps, [](auto f, auto l) {
+            IntroSort<PartitionMode::LOMUTO>(f, l);
+        }));
+        check(Time(in, out, reps, [](auto f, auto l) {
+            IntroSort<PartitionMode::BLOCK>(f, l);
+        }));
+        cout << endl;
+    }
+    return ok;
+}
+
+//------------------------------------------------------------------------------
+int main(int argc, char const* argv[]) {
+    const size_t n = argc > 1 ? stoull(argv[1]) : size_t(1) << 20;
+    const int reps = argc > 2 ? stoi(argv[2]) : 5;
+    vector<int> v = {5, 3, 9, 1, 3};
+    IntroSort(v.begin(), v.end(), greater<>());
+    if (!is_sorted(v.begin(), v.end(), greater<>())) {
+        cerr << "ERROR: not sorted" << endl;
+        return 1;
+    }
+    mt19937 gen(1);
+    cout << setprecision(3) << "ns/element" << endl
+         << "   type       input  std::sort   branchy    lomuto     block"
+         << endl;
+    bool ok = Bench<int32_t>("int", n, reps, gen);
+    ok = Bench<double>("double", n, reps, gen) && ok;
+    cout << (ok ? "results match" : "ERROR: results differ") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,195 @@
+// Author: Ugo Varetto
+// Introsort with selectable partitioning scheme:
+// - BRANCHY: std::partition, one hard to predict branch per element
+// - LOMUTO:  single pass, every element written back, the store position
+//            advances by the result of the comparison (cmov/setcc)
+// - BLOCK:   BlockQuicksort (Edelkamp, Weiss): comparison results are
+//            recorded as offsets into a block with branch free writes, then
+//            misplaced elements are swapped pairwise; the remainder is
+//            partitioned with LOMUTO
+// - AUTO:    LOMUTO when BranchlessPartition<value type> is true (arithmetic
+//            types by default, specialize to opt other types in), BRANCHY
+//            otherwise; BLOCK writes less and pays off for larger elements
+// Pivot: median of three quarter points, ninther above 128 elements; ranges
+// whose pivot equals the element preceding them are partitioned into
+// [== pivot, > pivot) and the equal part is skipped (few unique keys).
+// Falls back to heap sort after 2 * log2(n) levels, insertion sort below
+// 24 elements.
+//   IntroSort(v.begin(), v.end());
+//   IntroSort<PartitionMode::LOMUTO>(v.begin(), v.end(), greater<>());
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+enum class PartitionMode { AUTO, BRANCHY, LOMUTO, BLOCK };
+
+template <typename T>
+struct BranchlessPartition : std::is_arithmetic<T> {};
+
+namespace sort_detail {
+constexpr ptrdiff_t INSERTION_SORT_THRESHOLD = 24;
+constexpr ptrdiff_t NINTHER_THRESHOLD = 128;
+constexpr int BLOCK_SIZE = 64;
+
+template <typename It, typename Less>
+void InsertionSort(It first, It last, Less& less) {
+    if (first == last) return;
+    for (It i = first + 1; i != last; ++i) {
+        auto x = std::move(*i);
+        It j = i;
+        for (; j != first && less(x, *(j - 1)); --j) *j = std::move(*(j - 1));
+        *j = std::move(x);
+    }
+}
+
+template <typename It, typename Less>
+void Sort3(It a, It b, It c, Less& less) {
+    if (less(*b, *a)) std::iter_swap(a, b);
+    if (less(*c, *b)) std::iter_swap(b, c);
+    if (less(*b, *a)) std::iter_swap(a, b);
+}
+
+// median of samples moved to *first
+template <typename It, typename Less>
+void ChoosePivot(It first, It last, Less& less) {
+    const ptrdiff_t n = last - first;
+    const It a = first + n / 4;
+    const It b = first + n / 2;
+    const It c = first + 3 * n / 4;
+    if (n > NINTHER_THRESHOLD) {
+        Sort3(a - 1, a, a + 1, less);
+        Sort3(b - 1, b, b + 1, less);
+        Sort3(c - 1, c, c + 1, less);
+    }
+    Sort3(a, b, c, less);
+    std::iter_swap(first, b);
+}
+
+// All functions reorder [first, last) into [left(x), !left(x)) and return
+// the boundary
+template <typename It, typename Left>
+It PartitionLomuto(It first, It last, Left& left) {
+    It store = first;
+    for (It i = first; i != last; ++i) {
+        // [first, store) left, [store, i) right: *store moves to the end of
+        // the right part, x to store which advances only if x is left
+        auto x = std::move(*i);
+        const bool l = left(x);
+        *i = std::move(*store);
+        *store = std::move(x);
+        store += l;
+    }
+    return store;
+}
+
+template <typename It, typename Left>
+It PartitionBlock(It first, It last, Left& left) {
+    // offsets of misplaced elements in the first block from the left and in
+    // the last block from the right
+    unsigned char offl[BLOCK_SIZE];
+    unsigned char offr[BLOCK_SIZE];
+    int numl = 0, numr = 0, startl = 0, startr = 0;
+    while (last - first > 2 * BLOCK_SIZE) {
+        if (numl == 0) {
+            startl = 0;
+            for (int i = 0; i != BLOCK_SIZE; ++i) {
+                offl[numl] = (unsigned char)i;
+                numl += !left(first[i]);
+            }
+        }
+        if (numr == 0) {
+            startr = 0;
+            for (int i = 0; i != BLOCK_SIZE; ++i) {
+                offr[numr] = (unsigned char)i;
+                numr += left(*(last - 1 - i));
+            }
+        }
+        const int n = std::min(numl, numr);
+        for (int k = 0; k != n; ++k) {
+            std::iter_swap(first + offl[startl + k],
+                           last - 1 - offr[startr + k]);
+        }
+        numl -= n;
+        numr -= n;
+        startl += n;
+        startr += n;
+        if (numl == 0) first += BLOCK_SIZE;
+        if (numr == 0) last -= BLOCK_SIZE;
+    }
+    // a block with pending offsets is still inside [first, last)
+    return PartitionLomuto(first, last, left);
+}
+
+template <PartitionMode Mode, typename It, typename Left>
+It Partition(It first, It last, Left left) {
+    if constexpr (Mode == PartitionMode::BRANCHY) {
+        return std::partition(first, last, left);
+    } else if constexpr (Mode == PartitionMode::LOMUTO) {
+        return PartitionLomuto(first, last, left);
+    } else {
+        return PartitionBlock(first, last, left);
+    }
+}
+
+template <PartitionMode Mode, typename It, typename Less>
+void IntroSort(It first, It last, Less& less, int depth, bool leftmost) {
+    using T = typename std::iterator_traits<It>::value_type;
+    // copy small trivial pivots: a reference would be reloaded after each
+    // store into the range
+    using Pivot =
+        std::conditional_t<std::is_trivially_copyable<T>::value &&
+                               sizeof(T) <= 2 * sizeof(void*),
+                           const T, const T&>;
+    while (last - first > INSERTION_SORT_THRESHOLD) {
+        if (depth-- == 0) {
+            std::make_heap(first, last, less);
+            std::sort_heap(first, last, less);
+            return;
+        }
+        ChoosePivot(first, last, less);
+        Pivot pivot = *first;
+        // elements are >= the predecessor: if it equals the pivot move the
+        // elements equal to the pivot left and leave them there
+        if (!leftmost && !less(*(first - 1), pivot)) {
+            first = Partition<Mode>(first + 1, last, [&](const T& x) {
+                return !less(pivot, x);
+            });
+            continue;
+        }
+        It mid = Partition<Mode>(first + 1, last,
+                                 [&](const T& x) { return less(x, pivot); });
+        --mid;
+        std::iter_swap(first, mid);
+        // recurse into the smaller part, iterate on the larger one
+        if (mid - first < last - mid) {
+            IntroSort<Mode>(first, mid, less, depth, leftmost);
+            first = mid + 1;
+            leftmost = false;
+        } else {
+            IntroSort<Mode>(mid + 1, last, less, depth, false);
+            last = mid;
+        }
+    }
+    InsertionSort(first, last, less);
+}
+}  // namespace sort_detail
+
+//------------------------------------------------------------------------------
+template <PartitionMode Mode = PartitionMode::AUTO, typename It,
+          typename Less = std::less<>>
+void IntroSort(It first, It last, Less less = Less()) {
+    using T = typename std::iterator_traits<It>::value_type;
+    constexpr PartitionMode M =
+        Mode != PartitionMode::AUTO      ? Mode
+        : BranchlessPartition<T>::value ? PartitionMode::LOMUTO
+                                        : PartitionMode::BRANCHY;
+    int depth = 0;
+    for (ptrdiff_t n = last - first; n > 1; n /= 2) depth += 2;
+    sort_detail::IntroSort<M>(first, last, less, depth, true);
+}
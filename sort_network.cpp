@@ -0,0 +1,127 @@
+//
+// Sorting many small arrays: std::sort and insertion sort per array vs
+// compile time sorting networks, one array at a time and by column (AVX2
+// for float and int32_t), 4 to 32 elements
+// Usage: sort_network [total elements, default 2^22]
+// Author: Ugo Varetto
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "sort_network.h"
+
+using namespace std;
+
+using Clock = chrono::high_resolution_clock;
+template <typename TimeDiffNsT>
+constexpr double NsToSec(const TimeDiffNsT& diff) {
+    return double(chrono::duration_cast<chrono::nanoseconds>(diff).count()) /
+           1E9;
+}
+
+//------------------------------------------------------------------------------
+// 0-1 principle: a network sorts every input iff it sorts every sequence of
+// zeros and ones
+template <int N>
+constexpr bool Sorts01() {
+    for (uint32_t bits = 0; bits != (1u << N); ++bits) {
+        uint32_t b = bits;
+        for (const Comparator& p : SortNetwork<N>::PAIRS) {
+            const uint32_t i = (b >> p.i) & 1, j = (b >> p.j) & 1;
+            // min to i, max to j
+            b = (b & ~((1u << p.i) | (1u << p.j))) | ((i & j) << p.i) |
+                ((i | j) << p.j);
+        }
+        // sorted: zeros in the low, ones in the high positions
+        const int zeros = N - __builtin_popcount(b);
+        if (b != (((1u << N) - 1) >> zeros) << zeros) return false;
+    }
+    return true;
+}
+
+static_assert(Sorts01<4>() && Sorts01<6>() && Sorts01<8>() &&
+              Sorts01<11>() && Sorts01<12>());
+static_assert(SortNetwork<8>::COMPARATORS == 19);
+
+template <typename T>
+void InsertionSort(T* a, int n) {
+    for (int i = 1; i < n; ++i) {
+        const T x = a[i];
+        int j = i;
+        for (; j > 0 && x < a[j - 1]; --j) a[j] = a[j - 1];
+        a[j] = x;
+    }
+}
+
+template <typename F>
+double Time(size_t arrays, F f) {
+    const auto start = Clock::now();
+    f();
+    return 1E9 * NsToSec(Clock::now() - start) / arrays;
+}
+
+template <typename T, int N>
+bool Bench(const string& type, size_t total, mt19937& gen) {
+    const size_t arrays = total / N;
+    vector<T> in(arrays * N);
+    for (auto& x : in) x = T(gen() % 1000);
+    vector<T> ref = in, out = in, columns(in.size());
+    const double tstd = Time(arrays, [&] {
+        for (size_t a = 0; a != arrays; ++a) {
+            sort(ref.begin() + a * N, ref.begin() + (a + 1) * N);
+        }
+    });
+    const double tins = Time(arrays, [&] {
+        for (size_t a = 0; a != arrays; ++a) InsertionSort(&out[a * N], N);
+    });
+    bool ok = out == ref;
+    out = in;
+    const double tnet = Time(arrays, [&] {
+        for (size_t a = 0; a != arrays; ++a) {
+            SortNetwork<N>::Sort(&out[a * N]);
+        }
+    });
+    ok = ok && out == ref;
+    // transposed: element r of array a at r * arrays + a
+    for (size_t a = 0; a != arrays; ++a) {
+        for (int r = 0; r != N; ++r) columns[r * arrays + a] = in[a * N + r];
+    }
+    const double tcol = Time(arrays, [&] {
+        SortNetwork<N>::SortColumns(columns.data(), arrays);
+    });
+    for (size_t a = 0; a != arrays; ++a) {
+        for (int r = 0; r != N; ++r) {
+            ok = ok && columns[r * arrays + a] == ref[a * N + r];
+        }
+    }
+    cout << setw(7) << type << setw(4) << N << setw(6)
+         << SortNetwork<N>::COMPARATORS << setw(11) << tstd << setw(11)
+         << tins << setw(11) << tnet << setw(11) << tcol << endl;
+    return ok;
+}
+
+template <typename T, int... N>
+bool BenchAll(const string& type, size_t total, mt19937& gen) {
+    return (... & Bench<T, N>(type, total, gen));
+}
+
+//------------------------------------------------------------------------------
+int main(int argc, char const* argv[]) {
+    const size_t total = argc > 1 ? stoull(argv[1]) : size_t(1) << 22;
+    mt19937 gen(1);
+    cout << setprecision(3) << "ns/array" << endl
+         << "   type   N  cmps  std::sort  insertion    network    columns"
+         << endl;
+    bool ok = BenchAll<int32_t, 4, 8, 12, 16, 32>("int", total, gen);
+    ok = BenchAll<float, 4, 8, 12, 16, 32>("float", total, gen) && ok;
+    ok = BenchAll<double, 4, 8, 16>("double", total, gen) && ok;
+    cout << (ok ? "results match" : "ERROR: results differ") << endl;
+    return ok ? 0 : 1;
+}
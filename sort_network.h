@@ -0,0 +1,197 @@
+// Author: Ugo Varetto
+// Sorting networks for small fixed size arrays: the comparator sequence of
+// Batcher's odd-even merge sort is computed at compile time (size rounded up
+// to a power of two, comparators touching the padding dropped) and expanded
+// through an index sequence into straight line min/max pairs, no branches
+// and no loops.
+// Batcher's network is optimal (fewest comparators) up to 8 elements:
+// 1, 3, 5, 9, 12, 16, 19 comparators for 2 to 8 elements, 63 for 16, 191
+// for 32.
+// - Sort(a):                 one array, sorted in registers
+// - SortColumns(a, count):   count arrays stored by column, element r of
+//                            array c at a[r * count + c]; each comparator
+//                            is applied to 8 arrays at a time with AVX2
+//                            min/max for float and int32_t (selected at run
+//                            time), with the auto vectorized scalar loop
+//                            otherwise
+//   SortNetwork<8>::Sort(keys);
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "index_sequence.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SORT_NETWORK_X86
+#include <immintrin.h>
+#endif
+
+struct Comparator {
+    int i;
+    int j;
+};
+
+namespace sort_network_detail {
+// calls f(i, j) for each comparator, i < j
+template <typename F>
+constexpr void Batcher(int size, F f) {
+    int n = 1;
+    while (n < size) n *= 2;
+    for (int p = 1; p < n; p *= 2) {
+        for (int k = p; k >= 1; k /= 2) {
+            for (int j = k % p; j <= n - 1 - k; j += 2 * k) {
+                for (int i = 0; i <= std::min(k - 1, n - j - k - 1); ++i) {
+                    // same 2p sized block, second element not padding
+                    if ((i + j) / (2 * p) == (i + j + k) / (2 * p) &&
+                        i + j + k < size) {
+                        f(i + j, i + j + k);
+                    }
+                }
+            }
+        }
+    }
+}
+
+template <int N>
+constexpr int Count() {
+    int c = 0;
+    Batcher(N, [&c](int, int) { ++c; });
+    return c;
+}
+
+template <int N, int C>
+constexpr std::array<Comparator, C> Comparators() {
+    std::array<Comparator, C> a{};
+    int c = 0;
+    Batcher(N, [&](int i, int j) { a[c++] = Comparator{i, j}; });
+    return a;
+}
+
+template <typename T>
+inline void CompareSwap(T& a, T& b) {
+    if constexpr (std::is_integral<T>::value) {
+        // GCC turns min/max of integers into a branch around the cmovs:
+        // swap through a mask instead
+        using U = std::make_unsigned_t<T>;
+        const U m = U(0) - U(b < a);
+        const U d = (U(a) ^ U(b)) & m;
+        a = T(U(a) ^ d);
+        b = T(U(b) ^ d);
+    } else {
+        const T x = a;
+        a = std::min(x, b);
+        b = std::max(x, b);
+    }
+}
+
+#ifdef SORT_NETWORK_X86
+inline bool HasAVX2() {
+    __builtin_cpu_init();
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+}
+
+__attribute__((target("avx2"))) inline __m256 Load256(const float* p) {
+    return _mm256_loadu_ps(p);
+}
+__attribute__((target("avx2"))) inline __m256i Load256(const int32_t* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+__attribute__((target("avx2"))) inline void Store256(float* p, __m256 v) {
+    _mm256_storeu_ps(p, v);
+}
+__attribute__((target("avx2"))) inline void Store256(int32_t* p,
+                                                     __m256i v) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+}
+__attribute__((target("avx2"))) inline void CompareSwap256(__m256& a,
+                                                           __m256& b) {
+    const __m256 x = a;
+    a = _mm256_min_ps(x, b);
+    b = _mm256_max_ps(x, b);
+}
+__attribute__((target("avx2"))) inline void CompareSwap256(__m256i& a,
+                                                           __m256i& b) {
+    const __m256i x = a;
+    a = _mm256_min_epi32(x, b);
+    b = _mm256_max_epi32(x, b);
+}
+#endif
+}  // namespace sort_network_detail
+
+//------------------------------------------------------------------------------
+template <int N>
+class SortNetwork {
+    static_assert(N > 1, "at least two elements");
+
+   public:
+    static constexpr int SIZE = N;
+    static constexpr int COMPARATORS = sort_network_detail::Count<N>();
+    static constexpr std::array<Comparator, COMPARATORS> PAIRS =
+        sort_network_detail::Comparators<N, COMPARATORS>();
+
+    template <typename T>
+    static void Sort(T* a) {
+        T v[N];
+        std::copy(a, a + N, v);
+        Apply(v, Index());
+        std::copy(v, v + N, a);
+    }
+
+    template <typename T>
+    static void SortColumns(T* a, std::size_t count) {
+        std::size_t c = 0;
+#ifdef SORT_NETWORK_X86
+        if constexpr (std::is_same<T, float>::value ||
+                      std::is_same<T, int32_t>::value) {
+            if (sort_network_detail::HasAVX2()) {
+                c = count / 8 * 8;
+                ColumnsAVX2(a, count, c);
+            }
+        }
+#endif
+        for (const Comparator& p : PAIRS) {
+            T* ri = a + p.i * count;
+            T* rj = a + p.j * count;
+            for (std::size_t k = c; k < count; ++k) {
+                sort_network_detail::CompareSwap(ri[k], rj[k]);
+            }
+        }
+    }
+
+   private:
+    using Index = typename MakeIndexSequence<COMPARATORS>::Type;
+
+    template <typename T, int... I>
+    static void Apply(T* v, Idx<I...>) {
+        (..., sort_network_detail::CompareSwap(v[PAIRS[I].i], v[PAIRS[I].j]));
+    }
+
+#ifdef SORT_NETWORK_X86
+    template <typename V, int... I>
+    __attribute__((target("avx2"))) static void Apply256(V* v, Idx<I...>) {
+        (..., sort_network_detail::CompareSwap256(v[PAIRS[I].i],
+                                                  v[PAIRS[I].j]));
+    }
+
+    // columns [0, end), end multiple of 8
+    template <typename T>
+    __attribute__((target("avx2"))) static void ColumnsAVX2(T* a,
+                                                            std::size_t count,
+                                                            std::size_t end) {
+        using namespace sort_network_detail;
+        using V = decltype(Load256(a));
+        for (std::size_t c = 0; c != end; c += 8) {
+            V v[N];
+            for (int r = 0; r != N; ++r) v[r] = Load256(a + r * count + c);
+            Apply256(v, Index());
+            for (int r = 0; r != N; ++r) Store256(a + r * count + c, v[r]);
+        }
+    }
+#endif
+};
@@ -0,0 +1,144 @@
+//
+// Range Sum benchmark: SIMD kernels selected through concepts for
+// contiguous ranges vs generic iteration, throughput and float error of
+// FAST, PAIRWISE and KAHAN modes
+// Usage: sum [num elements, default 2^22] [repetitions, default 64]
+// Author: Ugo Varetto
+//
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "sum.h"
+
+using namespace std;
+
+using Clock = chrono::high_resolution_clock;
+template <typename TimeDiffNsT>
+constexpr double NsToSec(const TimeDiffNsT& diff) {
+    return double(chrono::duration_cast<chrono::nanoseconds>(diff).count()) /
+           1E9;
+}
+
+//------------------------------------------------------------------------------
+static_assert(SimdNumberRange<vector<float>&>);
+static_assert(SimdNumberRange<const vector<int32_t>&>);
+static_assert(!SimdNumberRange<list<int>&>);
+static_assert(!SimdNumberRange<vector<int64_t>&>);
+static_assert(NumberRange<list<int>&>);
+
+// generic path on a contiguous range: hide contiguity behind a view
+template <typename T>
+auto Generic(const vector<T>& v) {
+    return ranges::subrange(v.begin(), v.end()) |
+           views::transform([](T x) { return x; });
+}
+
+const char* Name(SumKernel k) {
+    switch (k) {
+        case SumKernel::SCALAR:
+            return "scalar";
+        case SumKernel::SSE2:
+            return "SSE2";
+        case SumKernel::AVX2:
+            return "AVX2";
+    }
+    return "";
+}
+
+const char* Name(SumMode m) {
+    switch (m) {
+        case SumMode::FAST:
+            return "fast";
+        case SumMode::PAIRWISE:
+            return "pairwise";
+        case SumMode::KAHAN:
+            return "kahan";
+    }
+    return "";
+}
+
+// returns last result, prints G elements/s
+template <typename F>
+auto Time(const string& label, size_t n, int reps, F f) {
+    decltype(f()) r{};
+    const auto start = Clock::now();
+    for (int i = 0; i != reps; ++i) r += f();
+    const double t = NsToSec(Clock::now() - start);
+    cout << "  " << label << string(max(1, 26 - int(label.size())), ' ')
+         << setw(8) << setprecision(3) << double(n) * reps / t / 1E9
+         << " G elements/s";
+    return r / reps;
+}
+
+template <typename T>
+void BenchFloat(const string& type, size_t n, int reps, mt19937& gen) {
+    vector<T> v(n);
+    uniform_real_distribution<T> dist(T(0), T(1));
+    for (auto& x : v) x = dist(gen);
+    long double ref = 0;
+    for (T x : v) ref += x;
+    auto error = [ref](T s) { return double(abs(s - ref) / ref); };
+    cout << type << ", G elements/s and relative error" << endl;
+    const T a = Time("accumulate", n, reps,
+                     [&] { return accumulate(v.begin(), v.end(), T(0)); });
+    cout << setw(10) << error(a) << endl;
+    for (SumMode m : {SumMode::FAST, SumMode::PAIRWISE, SumMode::KAHAN}) {
+        const T g = Time(string("generic ") + Name(m), n, reps,
+                         [&] { return Sum(Generic(v), m); });
+        cout << setw(10) << error(g) << endl;
+        for (SumKernel k :
+             {SumKernel::SCALAR, SumKernel::SSE2, SumKernel::AVX2}) {
+            if (!Supported(k)) continue;
+            const T s = Time(string(Name(k)) + " " + Name(m), n, reps,
+                             [&] { return Sum(v, m, k); });
+            cout << setw(10) << error(s) << endl;
+        }
+    }
+}
+
+bool BenchInt(size_t n, int reps, mt19937& gen) {
+    vector<int32_t> v(n);
+    uniform_int_distribution<int32_t> dist(INT32_MIN, INT32_MAX);
+    for (auto& x : v) x = dist(gen);
+    const list<int> l(v.begin(), v.end());
+    cout << "int32_t (64 bit accumulator)" << endl;
+    const int64_t a = Time("accumulate", n, reps, [&] {
+        return accumulate(v.begin(), v.end(), int64_t(0));
+    });
+    cout << endl;
+    bool ok = true;
+    for (SumKernel k : {SumKernel::SCALAR, SumKernel::SSE2, SumKernel::AVX2}) {
+        if (!Supported(k)) continue;
+        ok = Time(Name(k), n, reps,
+                  [&] { return Sum(v, SumMode::FAST, k); }) == a &&
+             ok;
+        cout << endl;
+    }
+    // list: one node at a time, prefetching can't run ahead
+    ok = Time("list<int>", n, max(1, reps / 8), [&] { return Sum(l); }) == a &&
+         ok;
+    cout << endl;
+    return ok;
+}
+
+//------------------------------------------------------------------------------
+int main(int argc, char const* argv[]) {
+    const size_t n = argc > 1 ? stoull(argv[1]) : size_t(1) << 22;
+    const int reps = argc > 2 ? stoi(argv[2]) : 64;
+    mt19937 gen(11);
+    cout << n << " elements, best kernel: " << Name(BestSumKernel()) << endl;
+    BenchFloat<float>("float", n, reps, gen);
+    BenchFloat<double>("double", n, reps, gen);
+    const bool ok = BenchInt(n, reps, gen);
+    cout << (ok ? "integer sums match" : "ERROR: integer sums differ") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,414 @@
+// Author: Ugo Varetto
+// Sum of a range of numbers, implementation selected through concepts:
+// contiguous sized ranges of float, double and int32_t go to SSE2 or AVX2
+// kernels picked at run time, any other input range of numbers is iterated.
+// Modes (floating point only, integer sums are exact):
+// - FAST: independent vector accumulators, order of additions is not
+//   preserved
+// - PAIRWISE: blocks summed with FAST then combined pairwise, error grows as
+//   O(log n) instead of O(n)
+// - KAHAN: compensated summation, one compensation term per lane, error
+//   independent of n, ~4x the operations
+// Integers are accumulated in 64 bits.
+
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <ranges>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SUM_X86
+#include <immintrin.h>
+#endif
+
+#include "reduce.h"
+
+template <typename T>
+concept number =
+    std::is_integral<T>::value || std::is_floating_point<T>::value;
+
+enum class SumMode { FAST, PAIRWISE, KAHAN };
+enum class SumKernel { SCALAR, SSE2, AVX2 };
+
+// Type of the result: floating point types sum in their own precision,
+// integers in 64 bits
+template <number T>
+using SumType = std::conditional_t<
+    std::is_floating_point<T>::value, T,
+    std::conditional_t<std::is_signed<T>::value, int64_t, uint64_t>>;
+
+template <typename R>
+concept NumberRange =
+    std::ranges::input_range<R> && number<std::ranges::range_value_t<R>>;
+
+template <typename T>
+concept SimdNumber = std::same_as<T, float> || std::same_as<T, double> ||
+                     std::same_as<T, int32_t>;
+
+template <typename R>
+concept SimdNumberRange =
+    NumberRange<R> && std::ranges::contiguous_range<R> &&
+    std::ranges::sized_range<R> && SimdNumber<std::ranges::range_value_t<R>>;
+
+inline bool Supported(SumKernel k) {
+#ifdef SUM_X86
+    switch (k) {
+        case SumKernel::SCALAR:
+            return true;
+        case SumKernel::SSE2:
+            return __builtin_cpu_supports("sse2");
+        case SumKernel::AVX2:
+            return __builtin_cpu_supports("avx2");
+    }
+    return false;
+#else
+    return k == SumKernel::SCALAR;
+#endif
+}
+
+inline SumKernel BestSumKernel() {
+    static const SumKernel best =
+        Supported(SumKernel::AVX2)   ? SumKernel::AVX2
+        : Supported(SumKernel::SSE2) ? SumKernel::SSE2
+                                     : SumKernel::SCALAR;
+    return best;
+}
+
+//------------------------------------------------------------------------------
+namespace sum_detail {
+// elements per block in PAIRWISE mode
+constexpr std::size_t PAIRWISE_BLOCK = 2048;
+
+template <typename T>
+SumType<T> FastScalar(const T* p, std::size_t n) {
+    using A = SumType<T>;
+    A acc[8] = {};
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        for (int k = 0; k != 8; ++k) acc[k] += A(p[i + k]);
+    }
+    for (; i != n; ++i) acc[0] += A(p[i]);
+    return TreeSum<0>(acc);
+}
+
+template <typename T>
+T KahanScalar(const T* p, std::size_t n, T s = T(0), T c = T(0)) {
+    for (std::size_t i = 0; i != n; ++i) {
+        const T y = p[i] - c;
+        const T t = s + y;
+        c = (t - s) - y;
+        s = t;
+    }
+    return s - c;
+}
+
+// combine per lane sums and compensations
+template <typename T, std::size_t W>
+T KahanLanes(const T (&s)[W], const T (&c)[W]) {
+    T v[2 * W];
+    for (std::size_t k = 0; k != W; ++k) {
+        v[2 * k] = s[k];
+        v[2 * k + 1] = -c[k];
+    }
+    return KahanScalar(v, 2 * W);
+}
+
+#ifdef SUM_X86
+// Overloads by element type, same code for float and double
+__attribute__((target("sse2"))) inline __m128 Load128(const float* p) {
+    return _mm_loadu_ps(p);
+}
+__attribute__((target("sse2"))) inline __m128d Load128(const double* p) {
+    return _mm_loadu_pd(p);
+}
+__attribute__((target("sse2"))) inline __m128 Add128(__m128 a, __m128 b) {
+    return _mm_add_ps(a, b);
+}
+__attribute__((target("sse2"))) inline __m128d Add128(__m128d a, __m128d b) {
+    return _mm_add_pd(a, b);
+}
+__attribute__((target("sse2"))) inline __m128 Sub128(__m128 a, __m128 b) {
+    return _mm_sub_ps(a, b);
+}
+__attribute__((target("sse2"))) inline __m128d Sub128(__m128d a, __m128d b) {
+    return _mm_sub_pd(a, b);
+}
+__attribute__((target("sse2"))) inline void Store128(float* p, __m128 v) {
+    _mm_storeu_ps(p, v);
+}
+__attribute__((target("sse2"))) inline void Store128(double* p, __m128d v) {
+    _mm_storeu_pd(p, v);
+}
+
+__attribute__((target("avx2"))) inline __m256 Load256(const float* p) {
+    return _mm256_loadu_ps(p);
+}
+__attribute__((target("avx2"))) inline __m256d Load256(const double* p) {
+    return _mm256_loadu_pd(p);
+}
+__attribute__((target("avx2"))) inline __m256 Add256(__m256 a, __m256 b) {
+    return _mm256_add_ps(a, b);
+}
+__attribute__((target("avx2"))) inline __m256d Add256(__m256d a, __m256d b) {
+    return _mm256_add_pd(a, b);
+}
+__attribute__((target("avx2"))) inline __m256 Sub256(__m256 a, __m256 b) {
+    return _mm256_sub_ps(a, b);
+}
+__attribute__((target("avx2"))) inline __m256d Sub256(__m256d a, __m256d b) {
+    return _mm256_sub_pd(a, b);
+}
+__attribute__((target("avx2"))) inline void Store256(float* p, __m256 v) {
+    _mm256_storeu_ps(p, v);
+}
+__attribute__((target("avx2"))) inline void Store256(double* p, __m256d v) {
+    _mm256_storeu_pd(p, v);
+}
+
+// four vector accumulators hide the add latency
+template <typename T>
+__attribute__((target("sse2"))) T FastSSE2(const T* p, std::size_t n) {
+    constexpr std::size_t W = 16 / sizeof(T);
+    const T zero[W] = {};
+    auto a0 = Load128(zero), a1 = a0, a2 = a0, a3 = a0;
+    std::size_t i = 0;
+    for (; i + 4 * W <= n; i += 4 * W) {
+        a0 = Add128(a0, Load128(p + i));
+        a1 = Add128(a1, Load128(p + i + W));
+        a2 = Add128(a2, Load128(p + i + 2 * W));
+        a3 = Add128(a3, Load128(p + i + 3 * W));
+    }
+    for (; i + W <= n; i += W) a0 = Add128(a0, Load128(p + i));
+    T lanes[W];
+    Store128(lanes, Add128(Add128(a0, a1), Add128(a2, a3)));
+    T s = TreeSum<0>(lanes);
+    for (; i != n; ++i) s += p[i];
+    return s;
+}
+
+template <typename T>
+__attribute__((target("avx2"))) T FastAVX2(const T* p, std::size_t n) {
+    constexpr std::size_t W = 32 / sizeof(T);
+    const T zero[W] = {};
+    auto a0 = Load256(zero), a1 = a0, a2 = a0, a3 = a0;
+    std::size_t i = 0;
+    for (; i + 4 * W <= n; i += 4 * W) {
+        a0 = Add256(a0, Load256(p + i));
+        a1 = Add256(a1, Load256(p + i + W));
+        a2 = Add256(a2, Load256(p + i + 2 * W));
+        a3 = Add256(a3, Load256(p + i + 3 * W));
+    }
+    for (; i + W <= n; i += W) a0 = Add256(a0, Load256(p + i));
+    T lanes[W];
+    Store256(lanes, Add256(Add256(a0, a1), Add256(a2, a3)));
+    T s = TreeSum<0>(lanes);
+    for (; i != n; ++i) s += p[i];
+    return s;
+}
+
+// Kahan per lane: s running sum, c lost low order bits
+template <typename T>
+__attribute__((target("sse2"))) T KahanSSE2(const T* p, std::size_t n) {
+    constexpr std::size_t W = 16 / sizeof(T);
+    const T zero[W] = {};
+    auto s = Load128(zero), c = s;
+    std::size_t i = 0;
+    for (; i + W <= n; i += W) {
+        const auto y = Sub128(Load128(p + i), c);
+        const auto t = Add128(s, y);
+        c = Sub128(Sub128(t, s), y);
+        s = t;
+    }
+    T ls[W], lc[W];
+    Store128(ls, s);
+    Store128(lc, c);
+    const T r = KahanLanes(ls, lc);
+    return KahanScalar(p + i, n - i, r);
+}
+
+template <typename T>
+__attribute__((target("avx2"))) T KahanAVX2(const T* p, std::size_t n) {
+    constexpr std::size_t W = 32 / sizeof(T);
+    const T zero[W] = {};
+    // two independent chains: the loop carried dependency is 4 adds deep
+    auto s0 = Load256(zero), c0 = s0, s1 = s0, c1 = s0;
+    std::size_t i = 0;
+    for (; i + 2 * W <= n; i += 2 * W) {
+        const auto y0 = Sub256(Load256(p + i), c0);
+        const auto y1 = Sub256(Load256(p + i + W), c1);
+        const auto t0 = Add256(s0, y0);
+        const auto t1 = Add256(s1, y1);
+        c0 = Sub256(Sub256(t0, s0), y0);
+        c1 = Sub256(Sub256(t1, s1), y1);
+        s0 = t0;
+        s1 = t1;
+    }
+    T ls0[W], lc0[W], ls1[W], lc1[W];
+    Store256(ls0, s0);
+    Store256(lc0, c0);
+    Store256(ls1, s1);
+    Store256(lc1, c1);
+    const T r[] = {KahanLanes(ls0, lc0), KahanLanes(ls1, lc1)};
+    return KahanScalar(p + i, n - i, KahanScalar(r, 2));
+}
+
+// int32 values widened to int64 lanes
+__attribute__((target("sse2"))) inline int64_t FastSSE2(const int32_t* p,
+                                                        std::size_t n) {
+    __m128i a0 = _mm_setzero_si128(), a1 = a0;
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+        const __m128i sign = _mm_srai_epi32(v, 31);
+        a0 = _mm_add_epi64(a0, _mm_unpacklo_epi32(v, sign));
+        a1 = _mm_add_epi64(a1, _mm_unpackhi_epi32(v, sign));
+    }
+    int64_t lanes[2];
+    _mm_storeu_si128((__m128i*)lanes, _mm_add_epi64(a0, a1));
+    int64_t s = lanes[0] + lanes[1];
+    for (; i != n; ++i) s += p[i];
+    return s;
+}
+
+__attribute__((target("avx2"))) inline int64_t FastAVX2(const int32_t* p,
+                                                        std::size_t n) {
+    __m256i a0 = _mm256_setzero_si256(), a1 = a0, a2 = a0, a3 = a0;
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i* q = (const __m128i*)(p + i);
+        a0 = _mm256_add_epi64(a0, _mm256_cvtepi32_epi64(_mm_loadu_si128(q)));
+        a1 = _mm256_add_epi64(a1,
+                              _mm256_cvtepi32_epi64(_mm_loadu_si128(q + 1)));
+        a2 = _mm256_add_epi64(a2,
+                              _mm256_cvtepi32_epi64(_mm_loadu_si128(q + 2)));
+        a3 = _mm256_add_epi64(a3,
+                              _mm256_cvtepi32_epi64(_mm_loadu_si128(q + 3)));
+    }
+    int64_t lanes[4];
+    _mm256_storeu_si256(
+        (__m256i*)lanes,
+        _mm256_add_epi64(_mm256_add_epi64(a0, a1), _mm256_add_epi64(a2, a3)));
+    int64_t s = TreeSum<0>(lanes);
+    for (; i != n; ++i) s += p[i];
+    return s;
+}
+#endif
+
+template <typename T>
+SumType<T> Fast(const T* p, std::size_t n, SumKernel k) {
+    switch (k) {
+#ifdef SUM_X86
+        case SumKernel::AVX2:
+            return FastAVX2(p, n);
+        case SumKernel::SSE2:
+            return FastSSE2(p, n);
+#endif
+        default:
+            return FastScalar(p, n);
+    }
+}
+
+template <typename T>
+T Kahan(const T* p, std::size_t n, SumKernel k) {
+    switch (k) {
+#ifdef SUM_X86
+        case SumKernel::AVX2:
+            return KahanAVX2(p, n);
+        case SumKernel::SSE2:
+            return KahanSSE2(p, n);
+#endif
+        default:
+            return KahanScalar(p, n);
+    }
+}
+
+template <typename T>
+T Pairwise(const T* p, std::size_t n, SumKernel k) {
+    if (n <= PAIRWISE_BLOCK) return Fast(p, n, k);
+    // split on a block boundary
+    const std::size_t h = (n / 2 + PAIRWISE_BLOCK - 1) / PAIRWISE_BLOCK *
+                          PAIRWISE_BLOCK;
+    return Pairwise(p, h, k) + Pairwise(p + h, n - h, k);
+}
+
+// Pairwise over a stream: partial[l] holds the sum of 2^l blocks, adding
+// a block carries like a binary counter
+template <typename T, typename I, typename S>
+T PairwiseStream(I i, S end) {
+    T partial[64];
+    uint64_t blocks = 0;
+    while (i != end) {
+        T s = T(0);
+        for (std::size_t k = 0; k != PAIRWISE_BLOCK && i != end; ++k, ++i)
+            s += T(*i);
+        int l = 0;
+        for (; blocks & (uint64_t(1) << l); ++l) s = partial[l] + s;
+        partial[l] = s;
+        ++blocks;
+    }
+    T s = T(0);
+    for (int l = 0; l != 64; ++l) {
+        if (blocks & (uint64_t(1) << l)) s = partial[l] + s;
+    }
+    return s;
+}
+}  // namespace sum_detail
+
+//------------------------------------------------------------------------------
+// Any input range of numbers
+template <NumberRange R>
+SumType<std::ranges::range_value_t<R>> Sum(R&& r,
+                                           SumMode mode = SumMode::FAST) {
+    using A = SumType<std::ranges::range_value_t<R>>;
+    auto i = std::ranges::begin(r);
+    const auto end = std::ranges::end(r);
+    if constexpr (std::is_floating_point<A>::value) {
+        if (mode == SumMode::PAIRWISE) {
+            return sum_detail::PairwiseStream<A>(i, end);
+        } else if (mode == SumMode::KAHAN) {
+            A s = A(0), c = A(0);
+            for (; i != end; ++i) {
+                const A y = A(*i) - c;
+                const A t = s + y;
+                c = (t - s) - y;
+                s = t;
+            }
+            return s - c;
+        }
+    }
+    A s = A(0);
+    for (; i != end; ++i) s += A(*i);
+    return s;
+}
+
+// Contiguous float, double and int32_t: vector kernels, k selects the
+// instruction set
+template <SimdNumberRange R>
+SumType<std::ranges::range_value_t<R>> Sum(R&& r, SumMode mode,
+                                           SumKernel k) {
+    using T = std::ranges::range_value_t<R>;
+    const T* p = std::ranges::data(r);
+    const std::size_t n = std::ranges::size(r);
+    if constexpr (std::is_floating_point<T>::value) {
+        switch (mode) {
+            case SumMode::PAIRWISE:
+                return sum_detail::Pairwise(p, n, k);
+            case SumMode::KAHAN:
+                return sum_detail::Kahan(p, n, k);
+            default:
+                break;
+        }
+    }
+    return sum_detail::Fast(p, n, k);
+}
+
+// more constrained than the NumberRange overload, same parameters
+template <SimdNumberRange R>
+SumType<std::ranges::range_value_t<R>> Sum(R&& r,
+                                           SumMode mode = SumMode::FAST) {
+    return Sum(r, mode, BestSumKernel());
+}
@@ -0,0 +1,153 @@
+//
+// Small buffer allocation from 1 to N threads: std::allocator vs
+// thread_cache_allocator.
+// - local: each thread replaces buffers of 8 to 1024 bytes in a ring of
+//   live allocations
+// - cross thread: half of the threads allocate and hand the buffers over
+//   to the other half, which frees them
+// Usage: thread_cache_allocator [max threads, default hardware concurrency]
+//                               [operations per thread, default 2^21]
+// Author: Ugo Varetto
+//
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "thread_cache_allocator.h"
+
+using namespace std;
+
+using Clock = chrono::high_resolution_clock;
+template <typename TimeDiffNsT>
+constexpr double NsToSec(const TimeDiffNsT& diff) {
+    return double(chrono::duration_cast<chrono::nanoseconds>(diff).count()) /
+           1E9;
+}
+
+//------------------------------------------------------------------------------
+struct Block {
+    char* p = nullptr;
+    size_t n = 0;
+};
+
+// sizes 8 to 1024, skewed towards small
+inline size_t NextSize(uint32_t& x) {
+    x = x * 1664525u + 1013904223u;
+    return size_t(8) << ((x >> 24) % 8);
+}
+
+template <typename A>
+void Local(size_t ops, uint32_t seed) {
+    A a;
+    Block ring[256];
+    uint32_t x = seed;
+    for (size_t i = 0; i != ops; ++i) {
+        Block& b = ring[i % 256];
+        if (b.p) a.deallocate(b.p, b.n);
+        b.n = NextSize(x);
+        b.p = a.allocate(b.n);
+        b.p[0] = char(i);
+    }
+    for (Block& b : ring) {
+        if (b.p) a.deallocate(b.p, b.n);
+    }
+}
+
+// single producer single consumer handoff through a ring of slots
+struct Mailbox {
+    static constexpr size_t SIZE = 1024;
+    Block slots[SIZE];
+    atomic<size_t> head{0};
+    atomic<size_t> tail{0};
+};
+
+template <typename A>
+void Producer(Mailbox& m, size_t ops, uint32_t seed) {
+    A a;
+    uint32_t x = seed;
+    for (size_t i = 0; i != ops; ++i) {
+        const size_t n = NextSize(x);
+        char* p = a.allocate(n);
+        p[0] = char(i);
+        while (i - m.tail.load(memory_order_acquire) == Mailbox::SIZE) {
+            this_thread::yield();
+        }
+        m.slots[i % Mailbox::SIZE] = Block{p, n};
+        m.head.store(i + 1, memory_order_release);
+    }
+}
+
+template <typename A>
+void Consumer(Mailbox& m, size_t ops) {
+    A a;
+    for (size_t i = 0; i != ops; ++i) {
+        while (m.head.load(memory_order_acquire) == i) this_thread::yield();
+        const Block b = m.slots[i % Mailbox::SIZE];
+        m.tail.store(i + 1, memory_order_release);
+        a.deallocate(b.p, b.n);
+    }
+}
+
+// ns per allocation + deallocation pair, wall clock over all threads
+template <typename A>
+double Time(int threads, size_t ops, bool cross) {
+    vector<thread> pool;
+    vector<unique_ptr<Mailbox>> mailboxes;
+    const auto start = Clock::now();
+    if (!cross) {
+        for (int t = 0; t != threads; ++t) {
+            pool.emplace_back(Local<A>, ops, uint32_t(t + 1));
+        }
+    } else {
+        for (int t = 0; t < threads; t += 2) {
+            mailboxes.emplace_back(new Mailbox);
+            Mailbox& m = *mailboxes.back();
+            pool.emplace_back(Producer<A>, ref(m), ops, uint32_t(t + 1));
+            pool.emplace_back(Consumer<A>, ref(m), ops);
+        }
+    }
+    for (auto& t : pool) t.join();
+    const size_t pairs = cross ? (threads + 1) / 2 * ops : threads * ops;
+    return 1E9 * NsToSec(Clock::now() - start) / pairs;
+}
+
+// freed by its static destructor, after the main thread's cache is gone
+vector<int, thread_cache_allocator<int>> atExit;
+
+//------------------------------------------------------------------------------
+int main(int argc, char const* argv[]) {
+    const int maxThreads =
+        argc > 1 ? stoi(argv[1]) : max(1, int(thread::hardware_concurrency()));
+    const size_t ops = argc > 2 ? stoull(argv[2]) : size_t(1) << 21;
+    using TC = thread_cache_allocator<char>;
+    // same allocator through rebind, in a container
+    vector<int, TC::rebind<int>::other> v(100, 1);
+    v.resize(10000, 2);
+    atExit.assign(1000, 3);
+    if (v[99] != 1 || v[9999] != 2) {
+        cerr << "ERROR: wrong content" << endl;
+        return 1;
+    }
+    cout << setprecision(3) << "ns/(allocate + deallocate), wall clock"
+         << endl
+         << "threads  local: std  thread cache  cross: std  thread cache"
+         << endl;
+    // powers of two below maxThreads, then maxThreads
+    vector<int> counts;
+    for (int t = 1; t < maxThreads; t *= 2) counts.push_back(t);
+    counts.push_back(maxThreads);
+    for (int t : counts) {
+        cout << setw(7) << t << setw(12) << Time<allocator<char>>(t, ops, false)
+             << setw(14) << Time<TC>(t, ops, false) << setw(12)
+             << Time<allocator<char>>(max(t, 2), ops, true) << setw(14)
+             << Time<TC>(max(t, 2), ops, true) << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,268 @@
+// Author: Ugo Varetto
+// Thread caching allocator with the same interface as pod_allocator
+// (vector_allocation.cpp), for many threads allocating small buffers.
+// - size classes: powers of two from 16 bytes to 32 KiB, larger requests go
+//   to operator new
+// - each thread keeps a free list per size class, no locking
+// - an empty list is refilled with a batch of blocks from the shared depot
+//   (one mutex per class) or, if the depot has none, from a new span cut
+//   into a batch of blocks
+// - a list longer than two batches gives one batch back to the depot
+// - blocks belong to no thread: a block freed by a thread other than the
+//   allocating one goes to the freeing thread's cache and reaches other
+//   threads through the depot; a thread's cache is given back to the depot
+//   when the thread exits
+// - frees and allocations after the thread's cache was destroyed (e.g. from
+//   static destructors) go one block at a time through the depot
+// Spans are never returned to the system.
+// Same contract as pod_allocator: allocate does not construct, elements must
+// be trivially destructible.
+//   vector<float, thread_cache_allocator<float>> v(n);
+
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+namespace thread_cache_detail {
+constexpr int NUM_CLASSES = 12;  // 16 << 11 = 32 KiB
+constexpr std::size_t MIN_BLOCK = 16;
+constexpr std::size_t MAX_BLOCK = MIN_BLOCK << (NUM_CLASSES - 1);
+constexpr std::size_t SPAN_BYTES = 64 * 1024;
+
+inline int SizeClass(std::size_t bytes) {
+    return bytes <= MIN_BLOCK ? 0 : 60 - __builtin_clzll(bytes - 1);
+}
+constexpr std::size_t BlockSize(int c) { return MIN_BLOCK << c; }
+// 64 blocks of 16 bytes to 2 blocks of 32 KiB
+constexpr int BatchSize(int c) {
+    return SPAN_BYTES / BlockSize(c) < 64 ? int(SPAN_BYTES / BlockSize(c))
+                                          : 64;
+}
+
+// free block: next block in the list, next batch in the depot
+struct Node {
+    Node* next;
+    Node* nextBatch;
+};
+
+// new span cut into a list of BatchSize(c) blocks
+inline Node* NewSpan(int c) {
+    const std::size_t size = BlockSize(c);
+    const int n = BatchSize(c);
+    char* span = static_cast<char*>(std::aligned_alloc(64, size * n));
+    if (!span) return nullptr;
+    for (int i = 0; i != n - 1; ++i) {
+        reinterpret_cast<Node*>(span + i * size)->next =
+            reinterpret_cast<Node*>(span + (i + 1) * size);
+    }
+    reinterpret_cast<Node*>(span + (n - 1) * size)->next = nullptr;
+    return reinterpret_cast<Node*>(span);
+}
+
+class Depot {
+   public:
+    // never destroyed: thread caches flush into it at thread exit, possibly
+    // after static destructors ran
+    static Depot& Instance() {
+        static Depot* depot = new Depot;
+        return *depot;
+    }
+    // list of BatchSize(c) blocks
+    Node* Pop(int c) {
+        std::lock_guard<std::mutex> lock(mutex_[c]);
+        Node* batch = batches_[c];
+        if (batch) batches_[c] = batch->nextBatch;
+        return batch;
+    }
+    void Push(int c, Node* batch) {
+        std::lock_guard<std::mutex> lock(mutex_[c]);
+        batch->nextBatch = batches_[c];
+        batches_[c] = batch;
+    }
+    // single blocks from exiting threads and from threads whose cache is
+    // gone, collected until they form a batch
+    void PushBlock(int c, Node* n) {
+        std::lock_guard<std::mutex> lock(orphanMutex_);
+        n->next = orphans_[c];
+        orphans_[c] = n;
+        if (++orphanCount_[c] == BatchSize(c)) {
+            Push(c, orphans_[c]);
+            orphans_[c] = nullptr;
+            orphanCount_[c] = 0;
+        }
+    }
+    // single block for threads whose cache is gone
+    Node* PopBlock(int c) {
+        std::lock_guard<std::mutex> lock(orphanMutex_);
+        if (!orphans_[c]) {
+            Node* batch = Pop(c);
+            if (!batch) batch = NewSpan(c);
+            if (!batch) return nullptr;
+            orphans_[c] = batch;
+            orphanCount_[c] = BatchSize(c);
+        }
+        Node* n = orphans_[c];
+        orphans_[c] = n->next;
+        --orphanCount_[c];
+        return n;
+    }
+
+   private:
+    Depot() = default;
+    // orphanMutex_ is taken before mutex_[c]
+    std::mutex mutex_[NUM_CLASSES];
+    Node* batches_[NUM_CLASSES] = {};
+    std::mutex orphanMutex_;
+    Node* orphans_[NUM_CLASSES] = {};
+    int orphanCount_[NUM_CLASSES] = {};
+};
+
+class ThreadCache {
+   public:
+    // nullptr after the thread's cache was destroyed: the flag is trivially
+    // destructible and stays valid until the thread ends
+    static ThreadCache* Instance() {
+        if (Destroyed()) return nullptr;
+        thread_local ThreadCache cache;
+        return &cache;
+    }
+    void* Allocate(int c) {
+        if (!head_[c] && !Refill(c)) return nullptr;
+        Node* n = head_[c];
+        head_[c] = n->next;
+        --count_[c];
+        return n;
+    }
+    void Deallocate(int c, void* p) {
+        Node* n = static_cast<Node*>(p);
+        n->next = head_[c];
+        head_[c] = n;
+        if (++count_[c] > 2 * BatchSize(c)) Release(c);
+    }
+    ~ThreadCache() {
+        Destroyed() = true;
+        for (int c = 0; c != NUM_CLASSES; ++c) {
+            while (count_[c] >= BatchSize(c)) Release(c);
+            // the depot only holds full batches: leftovers are pooled with
+            // those of other exiting threads
+            while (head_[c]) {
+                Node* n = head_[c];
+                head_[c] = n->next;
+                --count_[c];
+                Depot::Instance().PushBlock(c, n);
+            }
+        }
+    }
+
+   private:
+    ThreadCache() = default;
+    static bool& Destroyed() {
+        thread_local bool destroyed = false;
+        return destroyed;
+    }
+    bool Refill(int c) {
+        Node* batch = Depot::Instance().Pop(c);
+        if (!batch) batch = NewSpan(c);
+        if (!batch) return false;
+        head_[c] = batch;
+        count_[c] = BatchSize(c);
+        return true;
+    }
+    // move the first BatchSize(c) blocks to the depot
+    void Release(int c) {
+        Node* batch = head_[c];
+        Node* last = batch;
+        for (int i = 1; i != BatchSize(c); ++i) last = last->next;
+        head_[c] = last->next;
+        last->next = nullptr;
+        count_[c] -= BatchSize(c);
+        Depot::Instance().Push(c, batch);
+    }
+
+   private:
+    Node* head_[NUM_CLASSES] = {};
+    int count_[NUM_CLASSES] = {};
+};
+}  // namespace thread_cache_detail
+
+template <typename T>
+class thread_cache_allocator {
+   public:
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef T value_type;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    static_assert(alignof(T) <= thread_cache_detail::MIN_BLOCK,
+                  "over aligned type");
+
+    T* address(T& r) const { return &r; }
+
+    const T* address(const T& s) const { return &s; }
+
+    std::size_t max_size() const {
+        return (static_cast<std::size_t>(0) - static_cast<std::size_t>(1)) /
+               sizeof(T);
+    }
+
+    template <typename U>
+    struct rebind {
+        typedef thread_cache_allocator<U> other;
+    };
+
+    bool operator!=(const thread_cache_allocator& other) const {
+        return !(*this == other);
+    }
+
+    void destroy(T* const) const {}
+
+    // all instances share the per thread caches and the depot
+    bool operator==(const thread_cache_allocator&) const { return true; }
+
+    thread_cache_allocator() {}
+
+    thread_cache_allocator(const thread_cache_allocator&) {}
+
+    template <typename U>
+    thread_cache_allocator(const thread_cache_allocator<U>&) {}
+
+    ~thread_cache_allocator() {}
+
+    T* allocate(const std::size_t n) const {
+        using namespace thread_cache_detail;
+        const std::size_t bytes = n * sizeof(T);
+        if (bytes > MAX_BLOCK) return static_cast<T*>(::operator new(bytes));
+        const int c = SizeClass(bytes);
+        ThreadCache* cache = ThreadCache::Instance();
+        void* p = cache ? cache->Allocate(c) : Depot::Instance().PopBlock(c);
+        if (!p) throw std::bad_alloc();
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(T* const p, const std::size_t n) const {
+        using namespace thread_cache_detail;
+        const std::size_t bytes = n * sizeof(T);
+        if (bytes > MAX_BLOCK) {
+            ::operator delete(p);
+        } else if (ThreadCache* cache = ThreadCache::Instance()) {
+            cache->Deallocate(SizeClass(bytes), p);
+        } else {
+            Depot::Instance().PushBlock(SizeClass(bytes),
+                                        reinterpret_cast<Node*>(p));
+        }
+    }
+
+    template <typename U>
+    T* allocate(const std::size_t n, const U* /* const hint */) const {
+        return allocate(n);
+    }
+
+   private:
+    thread_cache_allocator& operator=(const thread_cache_allocator&);
+};
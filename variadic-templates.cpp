@@ -3,6 +3,11 @@
 #include <string>
 #include <tuple>
 
+#include "bit_dump.h"
+#include "bit_utils.h"
+#include "float_bits.h"
+#include "reduce.h"
+
 using namespace std;
 
 //------------------------------------------------------------------------------
@@ -57,6 +62,18 @@ T Apply(const T& init, F f, const ArgsT&... args) {
     return ApplyImpl(init, f, args...);
 }
 
+// Same result as Apply for associative f: arguments combined as a balanced
+// tree (or independent accumulators for long packs, see reduce.h) instead
+// of a chain of dependent calls
+template <typename T, typename F, typename... ArgsT>
+T ApplyTree(const T& init, F f, const ArgsT&... args) {
+    if constexpr (sizeof...(ArgsT) == 0) {
+        return init;
+    } else {
+        return T(f(ReducePack<T>(f, args...), init));
+    }
+}
+
 template <int S, int... N>
 struct Sequence : Sequence<S - 1, N..., sizeof...(N)> {};
 
@@ -174,31 +191,15 @@ void PrintXIndices(const F& f, const CustomIndex<I...>&) {
 
 #define i2f(es, m) (es << 23 | m)
 
-constexpr int NumBits(const uint32_t i) {
-    uint32_t mask = 1 << 31;
-    int count = 32;
-    while (!(mask & i)) {
-        --count;
-        mask >>= 1;
-    }
-    return count;
-}
+// number of bits required to represent i, 0 if i == 0
+constexpr int NumBits(const uint32_t i) { return BitWidth(i); }
+
 template <int B>
 struct Bi {
     int n = B;
     enum { bits = NumBits(B) };
 };
 
-template <typename T>
-constexpr void PrintBits(const T n, int start = 0,
-                         const int end = 8 * sizeof(T) - 1) {
-    static_assert(is_integral<T>::value);
-    for (int i = end; i >= start; --i) {
-        const int v = (n & (1 << i)) >> i;
-        cout << v;
-    }
-}
-
 template <typename T>
 constexpr int Zeros(const T n) {
     static_assert(is_floating_point<T>::value);
@@ -212,141 +213,17 @@ constexpr int Zeros(const T n) {
     return z;
 }
 
+// number of leading zero bits
 template <typename T>
 constexpr int Zerobits(const T n) {
-    static_assert(is_literal_type<T>::value);
-    // int cnt = 0;
-    const int end = 8 * sizeof(T) - 1;
-    int zeros = 0;
-    for (int cnt = end; cnt >= 0; cnt--) {
-        if (((n & (1 << cnt)) >> cnt) == 0)
-            ++zeros;
-        else
-            break;
-    }
-    return zeros;  // cnt > 0 ? cnt - 1: 0;
-}
-
-template <typename T>
-struct FloatTraits {};
-
-template <>
-struct FloatTraits<float> {
-    enum : int32_t {SIGN_BIT=31, MANTISSA_LENGTH=23, EXP_LENGTH=8};
-    //after right shift
-    enum : uint32_t {BIT_MASK=0x80000000, 
-                     MANTISSA_MASK=0x007FFFFF, 
-                     EXP_MASK=0x000000FF};
-    enum : int32_t {EXP_OFFSET=127};
-    enum : int32_t {MIN_EXP=126};
-    enum : uint32_t {POSITIVE_INFINITE=0x7F800000, 
-                     NEGATIVE_INFINITE=0xFF800000};
-    using IntType = int32_t;
-    using UIntType = uint32_t;
-};
-
-template <>
-struct FloatTraits<double> {
-    enum : int64_t {SIGN_BIT=63, MANTISSA_LENGTH=52, EXP_LENGTH=11};
-    //after right shift
-    enum : uint64_t {BIT_MASK=0x8000000000000000,
-                     MANTISSA_MASK=0x000FFFFFFFFFFFFF, 
-                     EXP_MASK=0x00000000000003FF};
-    enum : int64_t  {EXP_OFFSET=1023};
-    enum : int64_t  {MIN_EXP=1022};
-    enum : uint64_t {POSITIVE_INFINITE=0x7FF0000000000000, 
-                     NEGATIVE_INFINITE=0xFFF0000000000000};
-    using IntType = int64_t;
-    using UIntType = uint64_t;
-};
-
-
-
-//------------------------------------------------------------------------------
-// Convert 32 bit floating point number to 32 bit unsigned int. Can be used
-// in template parameter list or any other scope requiring a constexpr.
-// bits:
-// |31  |30........23|22.....0|
-//   ^        ^          ^
-// |sign|exponent-127|mantissa|
-// F = -1^sign x 2^exponent x 1. mantissa : normalized, x 1.****
-// denormalized: exponent = 0, F = -1^sign x 2^-126 * 0.mantissa
-// denormalization not supported, only floating point numbers with integer
-// part in signed 32 bit integer range supported
-// Algorithm, given floating point number F:
-// 1) extract sign, integer part, mantissa
-// 2) compute exponent E:
-//  2.1) if integer part >= 1 keep on incrementing the exponent E
-//       until 2^E < Integer(F), then decrement E to find the biggest exponent
-//       for which 2^E < F
-//  2.2) if integer part == 0 keep on incrementing the exponent E
-//       until 1/2^E > Mantissa(F)
-// 3) compute mantissa, F' = |F|:
-//  3.0) initialize number N to 2^E or 2^(-E) if number < 1,
-//       mantissa and mask to 0
-//  3.1) for each bit from position 22 to 0, while N != F:
-//         if N * (1 + mantissa + 1/2^bit_i) <= F'
-//           set bit i in mask to 1
-//           mantissa = mantissa + 1/2^bit_i
-//           N = N * (1 + mantissa + 1/2^bit_i)
-// 4) if |F| < 1 exponent is negative: E = -E
-// 5) return bitwise or of (sign << 31, E + 127 << 23, mantissa)
-// As per IEEE754 specification 127 is subtracted from exponent value, so
-// it needs to be added
-constexpr uint32_t IntFloat(const float f) {
-    const uint32_t S = (1 << 31) & int32_t(f);
-    uint32_t I = S ? -int32_t(f) : int32_t(f);
-    float M = S ? -f - I : f - I;
-    int E = 0;
-    if (I > 0) {
-        while ((1 << E) < I) ++E;
-        E = E > 0 ? E - 1 : 0;
-    } else {
-        E = 1;
-        while (1.f / (1 << E) > M) ++E;
-    }
-    const float F = I + M;
-    float N = I > 0 ? 1 << E : (1.f / (1 << E));
-    float m = 0.f;
-    uint32_t mantissa = 0;
-    for (int bit = 1; bit != 24; ++bit) {
-        const float r = 1.f / (1 << bit);
-        const float n = N * (1.f + m + r);
-        if (F - n >= 0) {
-            mantissa |= 1 << (23 - bit);
-            m += r;
-        }
-        if (F == n) break;
-    }
-    E = I > 0 ? E : -E;
-    const uint32_t X = ((E + 127) & 0x0000000FF) << 23;
-    return S | X | mantissa;
-}
-
-//------------------------------------------------------------------------------
-// Convert 32 bit unsigned integer to 32 bit floating point number.
-// Can be used in template parameter list or any other scope requiring
-// a constexpr.
-// Extract sign and exponent and sum bits in
-// mantissa (sum of 1/2^(22-bit position + 1)) where bit position in [0,22]
-constexpr float FloatInt(const uint32_t i) {
-    const float sign = (1 << 31) & i ? -1.f : 1.f;
-    int e = (((i & 0x7FFFFFFF) >> 23) & 0x000000FF) - 127;
-    const float factor = e > 0 ? 1 << e : 1.f / (1 << -e);
-    float mantissa = 0.f;
-    for (int bit = 0; bit != 23; ++bit) {
-        const int offset = 22 - bit;
-        const int b = (i & (1 << offset)) >> offset;
-        if (b) mantissa += 1.f / (1 << (bit + 1));
-    }
-    return sign * factor * (1.f + mantissa);
+    return CountLeadingZeros(n);
 }
 
-
 //------------------------------------------------------------------------------
 constexpr uint32_t mask(int bits, int offset = 0) {
-    return (((1 << bits) ^ (1 << bits)) | 1 << bits) << offset;
+    return uint32_t(Mask(bits, offset));
 }
+static_assert(mask(4, 4) == 0xF0 && mask(32) == 0xFFFFFFFF);
 
 template <uint32_t F>
 struct TF {
@@ -417,6 +294,10 @@ int main(int argc, char const* argv[]) {
     cout << NumBits(5625) << endl;
     uint32_t f = 127 << 23 | 5625 << 9;
 #endif
+    // same result as the chain of dependent calls in Apply
+    const auto mul = [](auto i1, auto i2) { return i1 * i2; };
+    cout << Apply(1, mul, 1, 2, 3, 4, 5, 6, 7) << ' '
+         << ApplyTree(1, mul, 1, 2, 3, 4, 5, 6, 7) << endl;
     union U {
         uint32_t i;
         float f;
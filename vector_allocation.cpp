@@ -1,6 +1,7 @@
 // Author: Ugo Varetto
-// buffer allocation performance tests: vector, vector+pod allocator (same as
-// vector), raw aligned buffer (faster)
+// buffer allocation performance tests: vector, vector+pod allocator, raw
+// aligned buffer (faster); pod_allocator and RawBuffer take large buffers
+// from the large block cache
 
 #include <sys/mman.h>
 #include <unistd.h>
@@ -8,8 +9,11 @@
 #include <chrono>
 #include <cstdlib>
 #include <iostream>
+#include <new>
 #include <vector>
 
+#include "raw_buffer.h"
+
 using namespace std;
 using Clock = chrono::high_resolution_clock;
 template <typename TimeDiffNsT>
@@ -89,9 +93,24 @@ class pod_allocator {
     ~pod_allocator() {}
 
     // The following will be different for each allocator.
-    T* allocate(const std::size_t n) const { return new T[n]; }
+    // Large buffers are recycled through the large block cache, as RawBuffer
+    // does
+    T* allocate(const std::size_t n) const {
+        LargeBlockCache& cache = LargeBlockCache::Instance();
+        if (n * sizeof(T) < cache.MinBytes()) return new T[n];
+        void* p = cache.Allocate(n * sizeof(T), alignof(T));
+        if (!p) throw std::bad_alloc();
+        return static_cast<T*>(p);
+    }
 
-    void deallocate(T* const p, const std::size_t n) const { delete[] p; }
+    // MinBytes() may have changed since allocation: blocks below the lowest
+    // value ever configured are new[] blocks, larger ones are looked up
+    void deallocate(T* const p, const std::size_t n) const {
+        LargeBlockCache& cache = LargeBlockCache::Instance();
+        if (n * sizeof(T) < cache.LowestMinBytes() || !cache.Release(p)) {
+            delete[] p;
+        }
+    }
 
     // The following will be the same for all allocators that ignore hints.
     template <typename U>
@@ -116,91 +135,6 @@ void PODAllocator() {
     cout << NsToSec(end - start) << endl;
 }
 
-class RawBuffer {
-   public:
-    RawBuffer(size_t size, size_t alignment = sizeof(void*))
-        : data_(nullptr), size_(0), alignment_(alignment), pageLocked_(false) {
-        // only way to report failure in constructor is to throw
-        // exceptions, check for size after construction, if zero
-        // an error occurred
-        Allocate(size, alignment);
-    }
-    RawBuffer(const RawBuffer& other) {
-        Allocate(other.size_, other.alignment_);
-#ifndef NO_STD_COPY
-        if (size_) {
-            // will call the right function e.g. __memcpy_avx_unaligned() etc.
-            // but required including <algorithm>
-            std::copy(other.data_, other.data_ + size_, data_);
-        }
-#else
-        memcpy(data_, other.data_, size_);
-#endif
-    }
-    RawBuffer(RawBuffer&& other) {
-        size_ = other.size_;
-        data_ = other.data_;
-        alignment_ = other.alignment_;
-        pageLocked_ = other.pageLocked_;
-        other.data_ = nullptr;
-    }
-    ~RawBuffer() { Destroy(); }
-    const char* Data() const { return data_; }
-    char* Data() { return data_; }
-    size_t Size() const { return size_; };
-    size_t Alignment() const { return alignment_; }
-    char& operator[](size_t i) { return data_[i]; }
-    char operator[](size_t i) const { return data_[i]; }  // no ref required
-
-   private:
-    void Allocate(size_t size, size_t alignment) {
-        data_ = static_cast<char*>(aligned_alloc(alignment, size));
-        if (data_) size_ = size;
-    }
-    void Destroy() {
-        if (!data_) return;
-        if (pageLocked_) munlock(data_, size_);
-        free(data_);
-    }
-
-   private:
-    char* data_;
-    size_t size_;
-    size_t alignment_;
-    bool pageLocked_;
-
-   private:
-    // only used by friend functions to return empty buffer in case of errors
-    RawBuffer() : size_(0), data_(nullptr), alignment_(0) {}
-    friend RawBuffer PageLockedBuffer(size_t);
-    friend void CopyBuffer(const RawBuffer& src, RawBuffer& dest);
-    // friend RawBuffer MMAlignedBuffer(size_t, size_t); //_mm_malloc/free of
-    // intrinsics TBD
-};
-
-RawBuffer PageLockedBuffer(size_t size) {
-    RawBuffer rb(size, sysconf(_SC_PAGESIZE));
-    if (!rb.Size()) return RawBuffer();
-    if (mlock(rb.Data(), size)) return RawBuffer();
-    return rb;
-}
-
-void CopyBuffer(const RawBuffer& src, RawBuffer& dest) {
-    const size_t sz = src.size_ <= dest.size_ ? src.size_ : dest.size_;
-#ifndef NO_STD_COPY
-    std::copy(src.data_, src.data_ + sz, dest.data_);
-#else
-    memcpy(dest.data_, src.data_, sz);
-#endif
-}
-
-char* begin(RawBuffer& rb) { return rb.Data(); }
-char* end(RawBuffer& rb) { return rb.Data() + rb.Size(); }
-const char* begin(const RawBuffer& rb) { return rb.Data(); }
-const char* end(const RawBuffer& rb) { return rb.Data() + rb.Size(); }
-const char* cbegin(const RawBuffer& rb) { return rb.Data(); }
-const char* cend(const RawBuffer& rb) { return rb.Data() + rb.Size(); }
-
 void FastBuffer() {
     auto start = Clock::now();
     // memory alignment changes performance, try with '1';
@@ -0,0 +1,194 @@
+// Author Ugo Varetto ugovaretto@gmail.com
+// Minimal Zip iterator: iterate over multiple sequences at once
+// for(auto [i, s]: Zip(ints, strings)) {...}
+
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+template <typename... ArgsT>
+class Zipper {
+  private:
+    using Indices =
+        std::make_index_sequence<std::tuple_size<std::tuple<ArgsT...>>::value>;
+    using ValueTuple = std::tuple<typename ArgsT::value_type&...>;
+    std::tuple<ArgsT...> its_;
+
+   public:
+    Zipper() = delete;
+    Zipper(ArgsT... i) : its_(i...) {}
+    Zipper(const Zipper&) = default;
+    Zipper(Zipper&&) = default;
+    Zipper& operator++() {
+        IncIterators(Indices{});
+        return *this;
+    }
+    ValueTuple operator*() const { return Values(Indices{}); }
+    bool operator==(const Zipper& other) const {
+        return Equal(other, Indices{});
+    }
+    bool operator!=(const Zipper& other) const { return !operator==(other); }
+    const std::tuple<ArgsT...>& Iterators() const { return its_; }
+
+   private:
+    template <size_t... I>
+    void IncIterators(const std::index_sequence<I...>&) {
+        (std::get<I>(its_)++, ...);
+    }
+    template <size_t... I>
+    ValueTuple Values(const std::index_sequence<I...>&) const {
+        return ValueTuple(*std::get<I>(its_)...);
+    }
+    template <size_t... I>
+    bool Equal(const Zipper& other, const std::index_sequence<I...>&) const {
+        return (... && (std::get<I>(its_) == std::get<I>(other.its_)));
+    }
+};
+
+template <typename... ArgsT>
+std::pair<Zipper<typename ArgsT::iterator...>,
+     Zipper<typename ArgsT::iterator...>> constexpr Zip(ArgsT&... seqs) {
+    return {Zipper<typename ArgsT::iterator...>(begin(seqs)...),
+            Zipper<typename ArgsT::iterator...>(end(seqs)...)};
+}
+
+template <typename... ArgsT>
+std::pair<Zipper<typename ArgsT::const_iterator...>,
+     Zipper<typename ArgsT::
+                const_iterator...>> constexpr Zip(const ArgsT&... seqs) {
+    return {Zipper<typename ArgsT::iterator...>(begin(seqs)...),
+            Zipper<typename ArgsT::iterator...>(end(seqs)...)};
+}
+
+template <typename F, typename S>
+F constexpr begin(std::pair<F, S> p) {return p.first;}
+
+template <typename F, typename S>
+F constexpr end(std::pair<F, S> p) {return p.second;}
+
+
+//------------------------------------------------------------------------------
+// Software prefetching adaptor: each increment issues __builtin_prefetch for
+// the elements Distance positions ahead in every sequence, and optionally for
+// the target of an index or pointer column (indirect mode), where hardware
+// prefetchers cannot predict the next address.
+// Requires random access iterators; nothing is prefetched within Distance of
+// the end.
+// Measured with prefetch_zip (512 MiB table, 2^24 rows, 2.1 GHz Xeon VM):
+// plain Zip 25-29 ns/row, all modes 22-29 ns/row at distances 4 to 64, the
+// index mode best at 16-32 (about 22 ns/row) but within run to run noise;
+// with independent rows out of order execution already overlaps the misses,
+// expect gains only when the loop body hides the loads behind dependent work.
+//   for (auto [k, q] : Prefetch<16>(Zip(keys, qty))) ...
+//   // also prefetch &table[keys[i + 16]]
+//   for (auto [k, q] : PrefetchIndirect<16, 0>(Zip(keys, qty), table)) ...
+//   // also prefetch *ptrs[i + 16]
+//   for (auto [p, q] : PrefetchIndirect<16, 0>(Zip(ptrs, qty))) ...
+
+namespace zip_detail {
+// direct prefetch only
+struct NoTarget {};
+// &table[index] from an index column
+template <std::size_t Column, typename TableIt>
+struct IndexTarget {
+    static constexpr std::size_t COLUMN = Column;
+    TableIt table;
+    template <typename I>
+    const void* operator()(const I& i) const {
+        return &table[i];
+    }
+};
+// pointed to object from a pointer column; the address is passed through
+// without dereferencing, null entries are fine since prefetches never fault
+template <std::size_t Column>
+struct PointerTarget {
+    static constexpr std::size_t COLUMN = Column;
+    template <typename U>
+    const void* operator()(U* p) const {
+        return p;
+    }
+    // smart pointers: operator-> returns the stored pointer
+    template <typename P>
+    const void* operator()(const P& p) const {
+        return p.operator->();
+    }
+};
+}  // namespace zip_detail
+
+template <int Distance, typename TargetT, typename... ArgsT>
+class PrefetchZipper {
+   private:
+    using Indices = std::make_index_sequence<sizeof...(ArgsT)>;
+    Zipper<ArgsT...> zip_;
+    std::ptrdiff_t remaining_;
+    TargetT target_;
+
+   public:
+    PrefetchZipper() = delete;
+    PrefetchZipper(const Zipper<ArgsT...>& z, std::ptrdiff_t remaining,
+                   TargetT target = TargetT())
+        : zip_(z), remaining_(remaining), target_(target) {}
+    PrefetchZipper& operator++() {
+        if (remaining_ > Distance) Prefetch(Indices{});
+        ++zip_;
+        --remaining_;
+        return *this;
+    }
+    auto operator*() const { return *zip_; }
+    bool operator==(const PrefetchZipper& other) const {
+        return zip_ == other.zip_;
+    }
+    bool operator!=(const PrefetchZipper& other) const {
+        return !operator==(other);
+    }
+
+   private:
+    template <size_t... I>
+    void Prefetch(const std::index_sequence<I...>&) const {
+        const auto& its = zip_.Iterators();
+        (__builtin_prefetch(&*(std::get<I>(its) + Distance)), ...);
+        if constexpr (!std::is_same<TargetT, zip_detail::NoTarget>::value) {
+            __builtin_prefetch(
+                target_(*(std::get<TargetT::COLUMN>(its) + Distance)));
+        }
+    }
+};
+
+namespace zip_detail {
+template <int Distance, typename TargetT, typename... ArgsT>
+std::pair<PrefetchZipper<Distance, TargetT, ArgsT...>,
+          PrefetchZipper<Distance, TargetT, ArgsT...>>
+MakePrefetch(const std::pair<Zipper<ArgsT...>, Zipper<ArgsT...>>& z,
+             TargetT target) {
+    const std::ptrdiff_t n = std::distance(std::get<0>(z.first.Iterators()),
+                                           std::get<0>(z.second.Iterators()));
+    return {PrefetchZipper<Distance, TargetT, ArgsT...>(z.first, n, target),
+            PrefetchZipper<Distance, TargetT, ArgsT...>(z.second, 0, target)};
+}
+}  // namespace zip_detail
+
+template <int Distance, typename... ArgsT>
+auto Prefetch(const std::pair<Zipper<ArgsT...>, Zipper<ArgsT...>>& z) {
+    return zip_detail::MakePrefetch<Distance>(z, zip_detail::NoTarget{});
+}
+
+// Column holds indices into table
+template <int Distance, std::size_t Column, typename TableT, typename... ArgsT>
+auto PrefetchIndirect(
+    const std::pair<Zipper<ArgsT...>, Zipper<ArgsT...>>& z, TableT& table) {
+    using It = decltype(std::begin(table));
+    return zip_detail::MakePrefetch<Distance>(
+        z, zip_detail::IndexTarget<Column, It>{std::begin(table)});
+}
+
+// Column holds pointers
+template <int Distance, std::size_t Column, typename... ArgsT>
+auto PrefetchIndirect(
+    const std::pair<Zipper<ArgsT...>, Zipper<ArgsT...>>& z) {
+    return zip_detail::MakePrefetch<Distance>(
+        z, zip_detail::PointerTarget<Column>{});
+}